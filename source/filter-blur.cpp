@@ -103,7 +103,7 @@ Filter::Blur::Blur() {
 		try {
 			std::shared_ptr<gs::effect> effect = std::make_shared<gs::effect>(kv.second);
 			m_effects.insert(std::make_pair(kv.first, effect));
-		} catch (std::runtime_error ex) {
+		} catch (const std::runtime_error& ex) {
 			P_LOG_ERROR("<filter-blur> Loading effect '%s' (path: '%s') failed with error(s): %s",
 				kv.first.c_str(), kv.second.c_str(), ex.what());
 			obs_leave_graphics();
@@ -151,7 +151,7 @@ void Filter::Blur::generate_gaussian_kernels() {
 		m_gaussianKernelTexture = std::make_shared<gs::texture>(
 			uint32_t(textureSizePOT), uint32_t(textureSizePOT), GS_R32F, 1, rbuf,
 			gs::texture::flags::None);
-	} catch (std::runtime_error ex) {
+	} catch (const std::runtime_error& ex) {
 		P_LOG_ERROR("<filter-blur> Failed to create gaussian kernel texture.");
 	}
 }
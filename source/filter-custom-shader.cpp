@@ -35,8 +35,13 @@ extern "C" {
 #define S			"Filter.CustomShader"
 
 /** Shader Definitions
- * - Only one technique, any number of passes.
- * - Technique must be named 'Draw'.
+ * - Technique drawing the final result must be named 'Draw'.
+ * - Optional intermediate techniques 'Pass0' to 'PassN' are drawn in order before 'Draw', each into its own
+ *   render target which later techniques can read through a texture parameter with the same name.
+ *   Annotations control each technique, e.g. 'technique Pass1 < float Scale = 0.5; string Format = "RGBA16F"; string Inputs = "Pass0"; >':
+ *   - Scale: Output size relative to the view size (float, 1/64 to 1, default 1).
+ *   - Format: Output color format (string, default "RGBA").
+ *   - Inputs: Passes this technique reads (string, default the previous pass). Also valid on 'Draw'.
  * - Parameters are split by the last underscore (_) to determine if it is a special parameter or not.
  *
  * Predefined Parameters:
@@ -383,9 +388,12 @@ bool Filter::CustomShader::Instance::video_tick_impl(float_t time) {
 }
 
 bool Filter::CustomShader::Instance::video_render_impl(gs_effect_t* parent_effect, uint32_t viewW, uint32_t viewH) {
-	// Render original source to render target.
+	// Render original source to render target, at a reduced size if requested.
+	// Image_Size and Image_Texel reflect the captured size, the output stays at the full size.
 	{
-		auto op = m_renderTarget->render(viewW, viewH);
+		uint32_t inputW = max(uint32_t(viewW * m_inputScale), 1u),
+			inputH = max(uint32_t(viewH * m_inputScale), 1u);
+		auto op = m_renderTarget->render(inputW, inputH);
 		vec4 black; vec4_zero(&black);
 		gs_ortho(0, (float_t)viewW, 0, (float_t)viewH, 0, 1);
 		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
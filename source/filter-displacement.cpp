@@ -50,11 +50,23 @@ Filter::Displacement::Displacement() {
 	sourceInfo.video_tick = video_tick;
 	sourceInfo.video_render = video_render;
 
+	// Load the effect once, instead of compiling it for every instance.
+	char* effectFile = obs_module_file("effects/displace.effect");
+	try {
+		m_effect = std::make_shared<gs::effect>(effectFile);
+	} catch (const std::runtime_error& ex) {
+		P_LOG_ERROR("<filter-displacement> Loading effect '%s' failed with error(s): %s",
+			effectFile, ex.what());
+		bfree(effectFile);
+		return;
+	}
+	bfree(effectFile);
+
 	obs_register_source(&sourceInfo);
 }
 
 Filter::Displacement::~Displacement() {
-
+	m_effect = nullptr;
 }
 
 const char * Filter::Displacement::get_name(void *) {
@@ -133,38 +145,31 @@ void Filter::Displacement::video_render(void *ptr, gs_effect_t *effect) {
 
 Filter::Displacement::Instance::Instance(obs_data_t *data,
 	obs_source_t *context) {
-	this->dispmap.texture = nullptr;
 	this->dispmap.createTime = 0;
 	this->dispmap.modifiedTime = 0;
 	this->dispmap.size = 0;
 	this->timer = 0;
+	this->fileChanged = false;
 	this->context = context;
 
-	obs_enter_graphics();
-	char* effectFile = obs_module_file("effects/displace.effect");
-	char* errorMessage = nullptr;
-	this->customEffect = gs_effect_create_from_file(effectFile,
-		&errorMessage);
-	bfree(effectFile);
-	if (errorMessage != nullptr) {
-		P_LOG_ERROR("%s", errorMessage);
-		bfree(errorMessage);
-	}
-	obs_leave_graphics();
-
 	update(data);
 }
 
 Filter::Displacement::Instance::~Instance() {
-	obs_enter_graphics();
-	gs_effect_destroy(customEffect);
-	gs_texture_destroy(dispmap.texture);
-	obs_leave_graphics();
+	dispmap.pending = nullptr;
+	dispmap.image = nullptr;
 }
 
 void Filter::Displacement::Instance::update(obs_data_t *data) {
-	updateDisplacementMap(obs_data_get_string(data,
-		S_FILTER_DISPLACEMENT_FILE));
+	// Loaded on the graphics thread by the next video_tick().
+	std::string file = obs_data_get_string(data, S_FILTER_DISPLACEMENT_FILE);
+	{
+		std::unique_lock<std::mutex> ulock(fileLock);
+		if (file != fileRequest) {
+			fileRequest = file;
+			fileChanged = true;
+		}
+	}
 
 	distance = float_t(obs_data_get_double(data,
 		S_FILTER_DISPLACEMENT_RATIO));
@@ -191,6 +196,12 @@ void Filter::Displacement::Instance::show() {}
 void Filter::Displacement::Instance::hide() {}
 
 void Filter::Displacement::Instance::video_tick(float time) {
+	if (fileChanged.exchange(false)) {
+		std::unique_lock<std::mutex> ulock(fileLock);
+		dispmap.file = fileRequest;
+		timer = 1.0;
+	}
+
 	timer += time;
 	if (timer >= 1.0) {
 		timer -= 1.0;
@@ -209,8 +220,21 @@ void Filter::Displacement::Instance::video_render(gs_effect_t *) {
 		baseW = obs_source_get_base_width(target),
 		baseH = obs_source_get_base_height(target);
 
+	// Swap in the new map once it finished decoding, keep the old one if
+	// decoding failed.
+	if (dispmap.pending && dispmap.pending->has_failed()) {
+		dispmap.pending = nullptr;
+	} else if (dispmap.pending && dispmap.pending->is_decoded()) {
+		dispmap.image = dispmap.pending;
+		dispmap.pending = nullptr;
+	}
+	std::shared_ptr<gs::texture> texture;
+	if (dispmap.image) {
+		texture = dispmap.image->get_texture();
+	}
+
 	// Skip rendering if our target, parent or context is not valid.
-	if (!target || !parent || !context || !dispmap.texture
+	if (!target || !parent || !context || !texture
 		|| !baseW || !baseH) {
 		obs_source_skip_video_filter(context);
 		return;
@@ -220,6 +244,7 @@ void Filter::Displacement::Instance::video_render(gs_effect_t *) {
 		OBS_ALLOW_DIRECT_RENDERING))
 		return;
 
+	gs_effect_t *customEffect = filterDisplacementInstance->m_effect->get_object();
 	gs_eparam_t *param;
 
 	vec2 texelScale;
@@ -240,7 +265,7 @@ void Filter::Displacement::Instance::video_render(gs_effect_t *) {
 
 	param = gs_effect_get_param_by_name(customEffect, "displacementMap");
 	if (param)
-		gs_effect_set_texture(param, dispmap.texture);
+		gs_effect_set_texture(param, texture->get_object());
 	else
 		P_LOG_ERROR("Failed to set texture param.");
 
@@ -248,36 +273,33 @@ void Filter::Displacement::Instance::video_render(gs_effect_t *) {
 }
 
 std::string Filter::Displacement::Instance::get_file() {
-	return dispmap.file;
+	std::unique_lock<std::mutex> ulock(fileLock);
+	return fileRequest;
 }
 
 void Filter::Displacement::Instance::updateDisplacementMap(std::string file) {
-	bool shouldUpdateTexture = false;
-
-	// Different File
-	if (file != dispmap.file) {
-		dispmap.file = file;
-		shouldUpdateTexture = true;
-	} else { // Different Timestamps
-		struct stat stats;
-		if (os_stat(dispmap.file.c_str(), &stats) != 0) {
-			shouldUpdateTexture = shouldUpdateTexture ||
-			(dispmap.createTime != stats.st_ctime) ||
-			(dispmap.modifiedTime != stats.st_mtime);
-			dispmap.createTime = stats.st_ctime;
-			dispmap.modifiedTime = stats.st_mtime;
-		}
+	struct stat stats;
+	if (os_stat(file.c_str(), &stats) != 0) {
+		// Missing files stop the filter like before.
+		dispmap.image = nullptr;
+		dispmap.pending = nullptr;
+		dispmap.loaded.clear();
+		return;
 	}
 
-	if (shouldUpdateTexture) {
-		obs_enter_graphics();
-		if (dispmap.texture) {
-			gs_texture_destroy(dispmap.texture);
-			dispmap.texture = nullptr;
-		}
-		if (os_file_exists(file.c_str()))
-			dispmap.texture =
-			gs_texture_create_from_file(dispmap.file.c_str());
-		obs_leave_graphics();
+	// Same file with the same timestamps, nothing to do.
+	if ((dispmap.loaded == file)
+		&& (dispmap.createTime == stats.st_ctime)
+		&& (dispmap.modifiedTime == stats.st_mtime)
+		&& (dispmap.size == (size_t)stats.st_size)) {
+		return;
 	}
+	dispmap.createTime = stats.st_ctime;
+	dispmap.modifiedTime = stats.st_mtime;
+	dispmap.size = (size_t)stats.st_size;
+	dispmap.loaded = file;
+
+	// Decoding happens in the background, keep using the old map until it
+	// is done.
+	dispmap.pending = gfx::texture_cache::load(file);
 }
@@ -19,6 +19,8 @@
 
 #pragma once
 #include "plugin.h"
+#include "gfx-texture-cache.h"
+#include "gs-effect.h"
 
 extern "C" {
 #pragma warning (push)
@@ -28,6 +30,9 @@ extern "C" {
 #pragma warning (pop)
 }
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #define S_FILTER_DISPLACEMENT				"Filter.Displacement"
@@ -42,6 +47,9 @@ namespace Filter {
 		Displacement();
 		~Displacement();
 
+		// Compiled once and shared by all instances.
+		std::shared_ptr<gs::effect> m_effect;
+
 		static const char *get_name(void *);
 
 		static void *create(obs_data_t *, obs_source_t *);
@@ -83,13 +91,26 @@ namespace Filter {
 			void updateDisplacementMap(std::string file);
 
 			obs_source_t *context;
-			gs_effect_t *customEffect;
 			float_t distance;
 			vec2 displacementScale;
+
+			// Written by update() on the UI thread, picked up by video_tick().
+			std::mutex fileLock;
+			std::string fileRequest;
+			std::atomic<bool> fileChanged;
+
+			// Only used on the graphics thread.
 			struct {
 				std::string file;
 
-				gs_texture_t* texture;
+				// Shared with every instance using the same file. The
+				// pending image replaces the current one once decoded.
+				std::shared_ptr<gfx::texture_cache::entry> image;
+				std::shared_ptr<gfx::texture_cache::entry> pending;
+
+				// File last loaded and its timestamps, a failed file is only
+				// tried again once it changes.
+				std::string loaded;
 				time_t createTime,
 					modifiedTime;
 				size_t size;
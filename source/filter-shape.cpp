@@ -19,6 +19,7 @@
 
 #include "filter-shape.h"
 #include "strings.h"
+#include "util-triangulation.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -65,7 +66,7 @@ static void initialize() {
 			snprintf(handle.data(), handle.size(), "%s.%" PRIu32, v,
 				point);
 			snprintf(name.data(), name.size(), P_TRANSLATE(v),
-				point);
+				(unsigned long long)point);
 			cacheValue x = std::make_pair(
 				std::string(handle.data()),
 				std::string(name.data()));
@@ -76,11 +77,10 @@ static void initialize() {
 }
 
 Filter::Shape::Shape() {
-	return; // Disabled for the time being. 3D Transform is better for this.
 	memset(&sourceInfo, 0, sizeof(obs_source_info));
 	sourceInfo.id = "obs-stream-effects-filter-shape";
 	sourceInfo.type = OBS_SOURCE_TYPE_FILTER;
-	sourceInfo.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_DEPRECATED;
+	sourceInfo.output_flags = OBS_SOURCE_VIDEO;
 	sourceInfo.get_name = get_name;
 	sourceInfo.get_defaults = get_defaults;
 	sourceInfo.get_properties = get_properties;
@@ -105,25 +105,31 @@ Filter::Shape::~Shape() {
 }
 
 const char * Filter::Shape::get_name(void *) {
-	return "Shape";
+	return P_TRANSLATE(P_SHAPE);
 }
 
 void Filter::Shape::get_defaults(obs_data_t *data) {
-	obs_data_set_default_bool(data, P_SHAPE_LOOP, true);
-	obs_data_set_default_int(data, P_SHAPE_POINTS, minimumPoints);
+	obs_data_set_default_bool(data, P_SHAPE_MASK, false);
+	obs_data_set_default_int(data, P_SHAPE_POINTS, 4);
 
+	// Default to the full frame, so a new filter starts as a valid shape.
+	const double_t corners[4][2] = {
+		{ 0, 0 }, { 100.0, 0 }, { 100.0, 100.0 }, { 0, 100.0 }
+	};
 	for (uint32_t point = 0; point < maximumPoints; point++) {
-		const char* vals[] = {
-			P_SHAPE_POINT_X,
-			P_SHAPE_POINT_Y,
-			P_SHAPE_POINT_U,
-			P_SHAPE_POINT_V
+		double_t x = point < 4 ? corners[point][0] : 0;
+		double_t y = point < 4 ? corners[point][1] : 0;
+		std::pair<const char*, double_t> vals[] = {
+			{ P_SHAPE_POINT_X, x },
+			{ P_SHAPE_POINT_Y, y },
+			{ P_SHAPE_POINT_U, x },
+			{ P_SHAPE_POINT_V, y }
 		};
-		for (const char* v : vals) {
-			auto strings = cache.find(std::make_pair(point, v));
+		for (auto v : vals) {
+			auto strings = cache.find(std::make_pair(point, v.first));
 			if (strings != cache.end()) {
 				obs_data_set_default_double(data,
-					strings->second.first.c_str(), 0);
+					strings->second.first.c_str(), v.second);
 			}
 		}
 	}
@@ -133,21 +139,14 @@ obs_properties_t * Filter::Shape::get_properties(void *) {
 	obs_properties_t *pr = obs_properties_create();
 	obs_property_t* p = NULL;
 
-	p = obs_properties_add_bool(pr, P_SHAPE_LOOP,
-		P_TRANSLATE(P_SHAPE_LOOP));
-	obs_property_set_long_description(p, P_DESC(P_SHAPE_LOOP));
-
-	p = obs_properties_add_list(pr, P_SHAPE_MODE, P_TRANSLATE(P_SHAPE_MODE),
-		obs_combo_type::OBS_COMBO_TYPE_LIST,
-		obs_combo_format::OBS_COMBO_FORMAT_INT);
-	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SHAPE_MODE)));
-	obs_property_list_add_int(p, P_TRANSLATE(P_SHAPE_MODE_TRIS), GS_TRIS);
-	obs_property_list_add_int(p, P_TRANSLATE(P_SHAPE_MODE_TRISTRIP),
-		GS_TRISTRIP);
+	p = obs_properties_add_bool(pr, P_SHAPE_MASK,
+		P_TRANSLATE(P_SHAPE_MASK));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SHAPE_MASK)));
+	obs_property_set_modified_callback(p, modified_properties);
 
 	p = obs_properties_add_int_slider(pr, P_SHAPE_POINTS,
 		P_TRANSLATE(P_SHAPE_POINTS), minimumPoints, maximumPoints, 1);
-	obs_property_set_long_description(p, P_DESC(P_SHAPE_POINTS));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SHAPE_POINTS)));
 	obs_property_set_modified_callback(p, modified_properties);
 
 	for (uint32_t point = 0; point < maximumPoints; point++) {
@@ -188,19 +187,20 @@ obs_properties_t * Filter::Shape::get_properties(void *) {
 bool Filter::Shape::modified_properties(obs_properties_t *pr, obs_property_t *,
 	obs_data_t *data) {
 	uint32_t points = (uint32_t)obs_data_get_int(data, P_SHAPE_POINTS);
+	bool mask = obs_data_get_bool(data, P_SHAPE_MASK);
 	for (uint32_t point = 0; point < maximumPoints; point++) {
 		bool visible = point < points ? true : false;
-		const char* vals[] = {
-			P_SHAPE_POINT_X,
-			P_SHAPE_POINT_Y,
-			P_SHAPE_POINT_U,
-			P_SHAPE_POINT_V
+		std::pair<const char*, bool> vals[] = {
+			{ P_SHAPE_POINT_X, visible },
+			{ P_SHAPE_POINT_Y, visible },
+			{ P_SHAPE_POINT_U, visible && !mask },
+			{ P_SHAPE_POINT_V, visible && !mask }
 		};
-		for (const char* v : vals) {
-			auto strings = cache.find(std::make_pair(point, v));
+		for (auto v : vals) {
+			auto strings = cache.find(std::make_pair(point, v.first));
 			if (strings != cache.end()) {
 				obs_property_set_visible(obs_properties_get(pr,
-					strings->second.first.c_str()), visible
+					strings->second.first.c_str()), v.second
 					);
 			}
 		}
@@ -253,11 +253,11 @@ void Filter::Shape::video_render(void *ptr, gs_effect_t *effect) {
 }
 
 Filter::Shape::Instance::Instance(obs_data_t *data, obs_source_t *context)
-	: context(context) {
+	: context(context), m_vertexBuffer(nullptr), m_texRender(nullptr),
+	m_mask(false), m_zstencil(nullptr), m_zstencilWidth(0), m_zstencilHeight(0) {
 	obs_enter_graphics();
 	m_vertexHelper = new gs::vertex_buffer(maximumPoints);
 	m_vertexHelper->set_uv_layers(1);
-	m_texRender = gs_texrender_create(GS_RGBA, GS_Z32F);
 	obs_leave_graphics();
 
 	update(data);
@@ -265,11 +265,15 @@ Filter::Shape::Instance::Instance(obs_data_t *data, obs_source_t *context)
 
 Filter::Shape::Instance::~Instance() {
 	obs_enter_graphics();
+	m_indexBuffer = nullptr;
 	delete m_vertexHelper;
+	gs_texrender_destroy(m_texRender);
+	gs_zstencil_destroy(m_zstencil);
 	obs_leave_graphics();
 }
 
 void Filter::Shape::Instance::update(obs_data_t *data) {
+	m_mask = obs_data_get_bool(data, P_SHAPE_MASK);
 	uint32_t points = (uint32_t)obs_data_get_int(data, P_SHAPE_POINTS);
 	m_vertexHelper->resize(points);
 	for (uint32_t point = 0; point < points; point++) {
@@ -309,12 +313,61 @@ void Filter::Shape::Instance::update(obs_data_t *data) {
 		*v.color = 0xFFFFFFFF;
 		v.position->z = 0.0f;
 	}
-	drawmode = (gs_draw_mode)obs_data_get_int(data, P_SHAPE_MODE);
+
+	// Only triangulate again if the outline changed, moving UVs is free.
+	bool changed = points != m_points.size();
+	m_points.resize(points);
+	for (uint32_t point = 0; point < points; point++) {
+		vec3* position = m_vertexHelper->get_positions() + point;
+		if ((m_points[point].x != position->x) || (m_points[point].y != position->y)) {
+			vec2_set(&m_points[point], position->x, position->y);
+			changed = true;
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	if (changed && !util::triangulate(m_points.data(), m_points.size(), indices)) {
+		// Self-intersecting outlines fall back to a fan, which is what
+		// convex shapes get anyway.
+		P_LOG_WARNING("<filter-shape> Outline of '%s' is not a simple polygon, drawing it as a fan.",
+			obs_source_get_name(context));
+		for (uint32_t point = 1; point + 1 < points; point++) {
+			indices.insert(indices.end(), { 0, point, point + 1 });
+		}
+	}
+
 	obs_enter_graphics();
+	if (changed) {
+		m_indexBuffer = std::make_unique<gs::index_buffer>((uint32_t)indices.size());
+		m_indexBuffer->insert(m_indexBuffer->end(), indices.begin(), indices.end());
+		m_indexBuffer->get();
+	}
 	m_vertexBuffer = m_vertexHelper->update();
 	obs_leave_graphics();
 }
 
+bool Filter::Shape::Instance::is_passthrough() {
+	// A rectangle covering the whole frame with untouched UVs changes
+	// nothing, so the source can render straight into the output. Masks
+	// ignore the UVs.
+	if (m_vertexHelper->size() != 4) {
+		return false;
+	}
+	bool corners[4] = { false, false, false, false };
+	for (uint32_t point = 0; point < 4; point++) {
+		gs::vertex v = m_vertexHelper->at(point);
+		if (!m_mask && ((v.position->x != v.uv[0]->x) || (v.position->y != v.uv[0]->y))) {
+			return false;
+		}
+		if (((v.position->x != 0) && (v.position->x != 1))
+			|| ((v.position->y != 0) && (v.position->y != 1))) {
+			return false;
+		}
+		corners[uint32_t(v.position->x) + uint32_t(v.position->y) * 2] = true;
+	}
+	return corners[0] && corners[1] && corners[2] && corners[3];
+}
+
 uint32_t Filter::Shape::Instance::get_width() {
 	return 0;
 }
@@ -341,12 +394,80 @@ void Filter::Shape::Instance::video_render(gs_effect_t *effect) {
 		baseH = obs_source_get_base_height(target);
 
 	// Skip rendering if our target, parent or context is not valid.
-	if (!target || !parent || !context || !m_vertexBuffer
-		|| !m_texRender || !baseW || !baseH) {
+	if (!target || !parent || !context || !m_vertexBuffer || !m_indexBuffer
+		|| !baseW || !baseH || is_passthrough()) {
 		obs_source_skip_video_filter(context);
 		return;
 	}
 
+	if (m_mask && gs_get_render_target()) {
+		render_mask(baseW, baseH, effect);
+	} else {
+		render_textured(baseW, baseH, effect);
+	}
+}
+
+void Filter::Shape::Instance::render_mask(uint32_t baseW, uint32_t baseH, gs_effect_t* effect) {
+	// Any intermediate render of the parent happens in here, so do it before
+	// the stencil buffer is attached.
+	if (!obs_source_process_filter_begin(context, GS_RGBA,
+		OBS_ALLOW_DIRECT_RENDERING)) {
+		obs_source_skip_video_filter(context);
+		return;
+	}
+
+	gs_texture_t* renderTarget = gs_get_render_target();
+	uint32_t width = gs_texture_get_width(renderTarget);
+	uint32_t height = gs_texture_get_height(renderTarget);
+	if (!m_zstencil || (m_zstencilWidth != width) || (m_zstencilHeight != height)) {
+		gs_zstencil_destroy(m_zstencil);
+		m_zstencil = gs_zstencil_create(width, height, GS_Z24_S8);
+		m_zstencilWidth = width;
+		m_zstencilHeight = height;
+	}
+	gs_zstencil_t* previousZStencil = gs_get_zstencil_target();
+	gs_set_render_target(renderTarget, m_zstencil);
+	gs_clear(GS_CLEAR_STENCIL, nullptr, 1.0f, 0);
+
+	gs_cull_mode cullMode = gs_get_cull_mode();
+	gs_set_cull_mode(GS_NEITHER);
+	gs_enable_depth_test(false);
+
+	// Libobs always compares against a reference of zero, so the outline
+	// increments the stencil and the parent is drawn where it isn't zero.
+	gs_matrix_push();
+	gs_matrix_scale3f((float)baseW, (float)baseH, 1.0);
+	gs_enable_color(false, false, false, false);
+	gs_enable_stencil_test(true);
+	gs_enable_stencil_write(true);
+	gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
+	gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_INCR);
+	gs_effect_t* solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+	while (gs_effect_loop(solid, "Solid")) {
+		gs_load_vertexbuffer(m_vertexBuffer);
+		gs_load_indexbuffer(m_indexBuffer->get(false));
+		gs_draw(GS_TRIS, 0, (uint32_t)m_indexBuffer->size());
+	}
+	gs_matrix_pop();
+
+	gs_enable_color(true, true, true, true);
+	gs_enable_stencil_write(false);
+	gs_stencil_function(GS_STENCIL_BOTH, GS_NOTEQUAL);
+	gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+	obs_source_process_filter_end(context,
+		effect ? effect : obs_get_base_effect(OBS_EFFECT_DEFAULT),
+		baseW, baseH);
+
+	gs_enable_stencil_test(false);
+	gs_set_cull_mode(cullMode);
+	gs_set_render_target(renderTarget, previousZStencil);
+}
+
+void Filter::Shape::Instance::render_textured(uint32_t baseW, uint32_t baseH, gs_effect_t* effect) {
+	if (!m_texRender) {
+		m_texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	}
+
 	gs_texrender_reset(m_texRender);
 	if (!gs_texrender_begin(m_texRender, baseW, baseH)) {
 		obs_source_skip_video_filter(context);
@@ -362,7 +483,6 @@ void Filter::Shape::Instance::video_render(gs_effect_t *effect) {
 	}
 	gs_texrender_end(m_texRender);
 	gs_texture* tex = gs_texrender_get_texture(m_texRender);
-
 	//gs_projection_push();
 	//gs_viewport_push();
 
@@ -372,23 +492,26 @@ void Filter::Shape::Instance::video_render(gs_effect_t *effect) {
 	gs_matrix_set(&alignedMatrix);
 	gs_matrix_scale3f((float)baseW, (float)baseH, 1.0);
 
+	gs_cull_mode cullMode = gs_get_cull_mode();
 	gs_set_cull_mode(GS_NEITHER);
+	gs_blend_state_push();
 	gs_enable_blending(false);
 	gs_enable_depth_test(false);
 	gs_enable_stencil_test(false);
 	gs_enable_stencil_write(false);
 	gs_enable_color(true, true, true, true);
-	gs_enable_depth_test(false);
 
 	gs_effect_t* eff = obs_get_base_effect(OBS_EFFECT_OPAQUE);
 	while (gs_effect_loop(eff, "Draw")) {
 		gs_effect_set_texture(gs_effect_get_param_by_name(eff, "image"),
 			tex);
 		gs_load_vertexbuffer(m_vertexBuffer);
-		gs_load_indexbuffer(nullptr);
-		gs_draw(drawmode, 0, (uint32_t)m_vertexHelper->size());
+		gs_load_indexbuffer(m_indexBuffer->get(false));
+		gs_draw(GS_TRIS, 0, (uint32_t)m_indexBuffer->size());
 	}
 
+	gs_blend_state_pop();
+	gs_set_cull_mode(cullMode);
 	gs_matrix_pop();
 	//gs_viewport_pop();
 	//gs_projection_pop();
@@ -19,19 +19,25 @@
 
 #pragma once
 #include "plugin.h"
+#include "gs-indexbuffer.h"
 #include "gs-vertexbuffer.h"
+#include <memory>
+#include <vector>
 
-#define P_SHAPE						"Shape"
-#define P_SHAPE_LOOP					"Shape.Loop"
-#define P_SHAPE_MODE					"Shape.Mode"
-#define P_SHAPE_MODE_TRIS				"Shape.Mode.Tris"
-#define P_SHAPE_MODE_TRISTRIP				"Shape.Mode.TriStrip"
-#define P_SHAPE_MODE					"Shape.Mode"
-#define P_SHAPE_POINTS					"Shape.Points"
-#define P_SHAPE_POINT_X					"Shape.Point.X"
-#define P_SHAPE_POINT_Y					"Shape.Point.Y"
-#define P_SHAPE_POINT_U					"Shape.Point.U"
-#define P_SHAPE_POINT_V					"Shape.Point.V"
+extern "C" {
+#pragma warning (push)
+#pragma warning (disable: 4201)
+#include "graphics/vec2.h"
+#pragma warning (pop)
+}
+
+#define P_SHAPE						"Filter.Shape"
+#define P_SHAPE_MASK					"Filter.Shape.Mask"
+#define P_SHAPE_POINTS					"Filter.Shape.Points"
+#define P_SHAPE_POINT_X					"Filter.Shape.Point.X"
+#define P_SHAPE_POINT_Y					"Filter.Shape.Point.Y"
+#define P_SHAPE_POINT_U					"Filter.Shape.Point.U"
+#define P_SHAPE_POINT_V					"Filter.Shape.Point.V"
 
 namespace Filter {
 	class Shape {
@@ -75,13 +81,27 @@ namespace Filter {
 			void video_tick(float);
 			void video_render(gs_effect_t*);
 
+			private:
+			bool is_passthrough();
+			void render_mask(uint32_t baseW, uint32_t baseH, gs_effect_t* effect);
+			void render_textured(uint32_t baseW, uint32_t baseH, gs_effect_t* effect);
+
 			private:
 			obs_source_t *context;
 			gs_effect_t *customEffect;
 			gs::vertex_buffer *m_vertexHelper;
 			gs_vertbuffer_t *m_vertexBuffer;
-			gs_draw_mode drawmode;
+
+			// Triangulated outline, only redone when the points move.
+			std::vector<vec2> m_points;
+			std::unique_ptr<gs::index_buffer> m_indexBuffer;
 			gs_texrender_t *m_texRender;
+
+			// Mask mode, only the outline's coverage is needed. It goes into a
+			// stencil buffer attached to the current render target.
+			bool m_mask;
+			gs_zstencil_t *m_zstencil;
+			uint32_t m_zstencilWidth, m_zstencilHeight;
 		};
 	};
 }
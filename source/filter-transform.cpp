@@ -20,6 +20,7 @@
 #include "filter-transform.h"
 #include "strings.h"
 #include "util-math.h"
+#include "util-matrix.h"
 
 extern "C" {
 	#pragma warning (push)
@@ -67,9 +68,25 @@ INITIALIZER(FilterTransformInit) {
 #define ST_ROTATION_ORDER_YZX			"Filter.Transform.Rotation.Order.YZX"
 #define ST_ROTATION_ORDER_ZXY			"Filter.Transform.Rotation.Order.ZXY"
 #define ST_ROTATION_ORDER_ZYX			"Filter.Transform.Rotation.Order.ZYX"
+#define ST_BEND					"Filter.Transform.Bend"
+#define ST_BEND_NONE				"Filter.Transform.Bend.None"
+#define ST_BEND_CYLINDER			"Filter.Transform.Bend.Cylinder"
+#define ST_BEND_SPHERE				"Filter.Transform.Bend.Sphere"
+#define ST_BEND_AMOUNT				"Filter.Transform.Bend.Amount"
+#define ST_SUBDIVISION_X			"Filter.Transform.Subdivision.X"
+#define ST_SUBDIVISION_Y			"Filter.Transform.Subdivision.Y"
+#define ST_COPIES				"Filter.Transform.Copies"
+#define ST_COPIES_OFFSET_X			"Filter.Transform.Copies.Offset.X"
+#define ST_COPIES_OFFSET_Y			"Filter.Transform.Copies.Offset.Y"
+#define ST_COPIES_OFFSET_Z			"Filter.Transform.Copies.Offset.Z"
+#define ST_COPIES_ROTATION_X			"Filter.Transform.Copies.Rotation.X"
+#define ST_COPIES_ROTATION_Y			"Filter.Transform.Copies.Rotation.Y"
+#define ST_COPIES_ROTATION_Z			"Filter.Transform.Copies.Rotation.Z"
+#define ST_COPIES_SCALE				"Filter.Transform.Copies.Scale"
+#define ST_ANIMATION				"Filter.Transform.Animation"
+#define ST_ANIMATION_LOOP			"Filter.Transform.Animation.Loop"
+#define ST_ANIMATION_KEYFRAMES			"Filter.Transform.Animation.Keyframes"
 
-static const float farZ = 2097152.0f; // 2 pow 21
-static const float nearZ = 1.0f / farZ;
 static const float valueLimit = 65536.0f;
 
 enum class CameraMode : int32_t {
@@ -77,6 +94,12 @@ enum class CameraMode : int32_t {
 	Perspective
 };
 
+enum BendMode : int64_t {
+	None,
+	Cylinder,
+	Sphere,
+};
+
 enum RotationOrder : int64_t {
 	XYZ,
 	XZY,
@@ -129,6 +152,21 @@ void Filter::Transform::get_defaults(obs_data_t *data) {
 	obs_data_set_default_bool(data, S_ADVANCED, false);
 	obs_data_set_default_int(data, ST_ROTATION_ORDER,
 		RotationOrder::ZXY); //ZXY
+	obs_data_set_default_int(data, ST_BEND, BendMode::None);
+	obs_data_set_default_double(data, ST_BEND_AMOUNT, 50.0);
+	obs_data_set_default_int(data, ST_SUBDIVISION_X, 16);
+	obs_data_set_default_int(data, ST_SUBDIVISION_Y, 16);
+	obs_data_set_default_int(data, ST_COPIES, 1);
+	obs_data_set_default_double(data, ST_COPIES_OFFSET_X, 0);
+	obs_data_set_default_double(data, ST_COPIES_OFFSET_Y, 0);
+	obs_data_set_default_double(data, ST_COPIES_OFFSET_Z, 0);
+	obs_data_set_default_double(data, ST_COPIES_ROTATION_X, 0);
+	obs_data_set_default_double(data, ST_COPIES_ROTATION_Y, 0);
+	obs_data_set_default_double(data, ST_COPIES_ROTATION_Z, 0);
+	obs_data_set_default_double(data, ST_COPIES_SCALE, 100.0);
+	obs_data_set_default_bool(data, ST_ANIMATION, false);
+	obs_data_set_default_bool(data, ST_ANIMATION_LOOP, true);
+	obs_data_set_default_string(data, ST_ANIMATION_KEYFRAMES, "");
 }
 
 obs_properties_t * Filter::Transform::get_properties(void *) {
@@ -201,6 +239,54 @@ obs_properties_t * Filter::Transform::get_properties(void *) {
 		}
 	}
 
+	p = obs_properties_add_list(pr, ST_BEND, P_TRANSLATE(ST_BEND),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(ST_BEND)));
+	obs_property_list_add_int(p, P_TRANSLATE(ST_BEND_NONE), BendMode::None);
+	obs_property_list_add_int(p, P_TRANSLATE(ST_BEND_CYLINDER), BendMode::Cylinder);
+	obs_property_list_add_int(p, P_TRANSLATE(ST_BEND_SPHERE), BendMode::Sphere);
+	obs_property_set_modified_callback(p, modified_properties);
+
+	p = obs_properties_add_float_slider(pr, ST_BEND_AMOUNT,
+		P_TRANSLATE(ST_BEND_AMOUNT), -100.0, 100.0, 0.01);
+	obs_property_set_long_description(p,
+		P_TRANSLATE(P_DESC(ST_BEND_AMOUNT)));
+
+	p = obs_properties_add_int_slider(pr, ST_COPIES, P_TRANSLATE(ST_COPIES),
+		1, 64, 1);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(ST_COPIES)));
+	obs_property_set_modified_callback(p, modified_properties);
+	{
+		std::pair<const char*, const char*> entries[] = {
+			std::make_pair(ST_COPIES_OFFSET_X, P_DESC(ST_COPIES_OFFSET_X)),
+			std::make_pair(ST_COPIES_OFFSET_Y, P_DESC(ST_COPIES_OFFSET_Y)),
+			std::make_pair(ST_COPIES_OFFSET_Z, P_DESC(ST_COPIES_OFFSET_Z)),
+		};
+		for (auto kv : entries) {
+			p = obs_properties_add_float_slider(pr, kv.first,
+				P_TRANSLATE(kv.first), -1000, 1000, 0.01);
+			obs_property_set_long_description(p,
+				P_TRANSLATE(kv.second));
+		}
+	}
+	{
+		std::pair<const char*, const char*> entries[] = {
+			std::make_pair(ST_COPIES_ROTATION_X, P_DESC(ST_COPIES_ROTATION_X)),
+			std::make_pair(ST_COPIES_ROTATION_Y, P_DESC(ST_COPIES_ROTATION_Y)),
+			std::make_pair(ST_COPIES_ROTATION_Z, P_DESC(ST_COPIES_ROTATION_Z)),
+		};
+		for (auto kv : entries) {
+			p = obs_properties_add_float_slider(pr, kv.first,
+				P_TRANSLATE(kv.first), -180, 180, 0.01);
+			obs_property_set_long_description(p,
+				P_TRANSLATE(kv.second));
+		}
+	}
+	p = obs_properties_add_float_slider(pr, ST_COPIES_SCALE,
+		P_TRANSLATE(ST_COPIES_SCALE), 1.0, 1000.0, 0.01);
+	obs_property_set_long_description(p,
+		P_TRANSLATE(P_DESC(ST_COPIES_SCALE)));
+
 	p = obs_properties_add_bool(pr, S_ADVANCED, P_TRANSLATE(S_ADVANCED));
 	obs_property_set_modified_callback(p, modified_properties);
 
@@ -222,6 +308,32 @@ obs_properties_t * Filter::Transform::get_properties(void *) {
 	obs_property_list_add_int(p, P_TRANSLATE(ST_ROTATION_ORDER_ZYX),
 		RotationOrder::ZYX);
 
+	{
+		std::pair<const char*, const char*> entries[] = {
+			std::make_pair(ST_SUBDIVISION_X, P_DESC(ST_SUBDIVISION_X)),
+			std::make_pair(ST_SUBDIVISION_Y, P_DESC(ST_SUBDIVISION_Y)),
+		};
+		for (auto kv : entries) {
+			p = obs_properties_add_int_slider(pr, kv.first,
+				P_TRANSLATE(kv.first), 1, 64, 1);
+			obs_property_set_long_description(p,
+				P_TRANSLATE(kv.second));
+		}
+	}
+
+	p = obs_properties_add_bool(pr, ST_ANIMATION, P_TRANSLATE(ST_ANIMATION));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(ST_ANIMATION)));
+	obs_property_set_modified_callback(p, modified_properties);
+
+	p = obs_properties_add_bool(pr, ST_ANIMATION_LOOP,
+		P_TRANSLATE(ST_ANIMATION_LOOP));
+	obs_property_set_long_description(p,
+		P_TRANSLATE(P_DESC(ST_ANIMATION_LOOP)));
+
+	p = obs_properties_add_text(pr, ST_ANIMATION_KEYFRAMES,
+		P_TRANSLATE(ST_ANIMATION_KEYFRAMES), OBS_TEXT_MULTILINE);
+	obs_property_set_long_description(p,
+		P_TRANSLATE(P_DESC(ST_ANIMATION_KEYFRAMES)));
 
 	return pr;
 }
@@ -247,6 +359,30 @@ bool Filter::Transform::modified_properties(obs_properties_t *pr,
 	obs_property_set_visible(obs_properties_get(pr,
 		ST_ROTATION_ORDER), advancedVisible);
 
+	bool copiesVisible = obs_data_get_int(d, ST_COPIES) > 1;
+	const char* copyProperties[] = {
+		ST_COPIES_OFFSET_X, ST_COPIES_OFFSET_Y, ST_COPIES_OFFSET_Z,
+		ST_COPIES_ROTATION_X, ST_COPIES_ROTATION_Y, ST_COPIES_ROTATION_Z,
+		ST_COPIES_SCALE,
+	};
+	for (const char* name : copyProperties) {
+		obs_property_set_visible(obs_properties_get(pr, name), copiesVisible);
+	}
+
+	bool bendVisible = obs_data_get_int(d, ST_BEND) != BendMode::None;
+	obs_property_set_visible(obs_properties_get(pr,
+		ST_BEND_AMOUNT), bendVisible);
+	obs_property_set_visible(obs_properties_get(pr,
+		ST_SUBDIVISION_X), bendVisible && advancedVisible);
+	obs_property_set_visible(obs_properties_get(pr,
+		ST_SUBDIVISION_Y), bendVisible && advancedVisible);
+
+	bool animationVisible = obs_data_get_bool(d, ST_ANIMATION);
+	obs_property_set_visible(obs_properties_get(pr,
+		ST_ANIMATION_LOOP), animationVisible);
+	obs_property_set_visible(obs_properties_get(pr,
+		ST_ANIMATION_KEYFRAMES), animationVisible);
+
 	return true;
 }
 
@@ -288,35 +424,33 @@ void Filter::Transform::video_render(void *ptr, gs_effect_t *effect) {
 
 Filter::Transform::Instance::Instance(obs_data_t *data, obs_source_t *context) :
 	m_sourceContext(context), m_vertexHelper(nullptr),
-	m_vertexBuffer(nullptr), m_texRender(nullptr), m_shapeRender(nullptr),
+	m_vertexBuffer(nullptr), m_meshColumns(0), m_meshRows(0), m_meshCopies(0),
+	m_texRender(nullptr),
 	m_isCameraOrthographic(true), m_cameraFieldOfView(90.0),
 	m_isInactive(false), m_isHidden(false), m_isMeshUpdateRequired(false),
+	m_bendMode(BendMode::None), m_bendAmount(0), m_subdivisionX(1), m_subdivisionY(1),
+	m_copies(1), m_copyScale(1.0f),
+	m_isAnimated(false),
 	m_rotationOrder(RotationOrder::ZXY) {
 	m_position = std::make_unique<util::vec3a>();
 	m_rotation = std::make_unique<util::vec3a>();
 	m_scale = std::make_unique<util::vec3a>();
 	m_shear = std::make_unique<util::vec3a>();
+	m_copyOffset = std::make_unique<util::vec3a>();
+	m_copyRotation = std::make_unique<util::vec3a>();
 
 	vec3_set(m_position.get(), 0, 0, 0);
 	vec3_set(m_rotation.get(), 0, 0, 0);
 	vec3_set(m_scale.get(), 1, 1, 1);
 
-	obs_enter_graphics();
-	m_texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
-	m_shapeRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
-	m_vertexHelper = new gs::vertex_buffer(4);
-	m_vertexHelper->set_uv_layers(1);
-	m_vertexHelper->resize(4);
-	obs_leave_graphics();
-
 	update(data);
 }
 
 Filter::Transform::Instance::~Instance() {
 	obs_enter_graphics();
+	m_indexBuffer = nullptr;
 	delete m_vertexHelper;
 	gs_texrender_destroy(m_texRender);
-	gs_texrender_destroy(m_shapeRender);
 	obs_leave_graphics();
 }
 
@@ -340,7 +474,64 @@ void Filter::Transform::Instance::update(obs_data_t *data) {
 	m_shear->x = (float)obs_data_get_double(data, ST_SHEAR_X) / 100.0f;
 	m_shear->y = (float)obs_data_get_double(data, ST_SHEAR_Y) / 100.0f;
 	m_shear->z = 0.0f;
+	m_bendMode = (uint32_t)obs_data_get_int(data, ST_BEND);
+	m_bendAmount = (float)obs_data_get_double(data, ST_BEND_AMOUNT) / 100.0f;
+	m_subdivisionX = (uint32_t)obs_data_get_int(data, ST_SUBDIVISION_X);
+	m_subdivisionY = (uint32_t)obs_data_get_int(data, ST_SUBDIVISION_Y);
+	m_copies = (uint32_t)obs_data_get_int(data, ST_COPIES);
+	m_copyOffset->x = (float)obs_data_get_double(data, ST_COPIES_OFFSET_X) / 100.0f;
+	m_copyOffset->y = (float)obs_data_get_double(data, ST_COPIES_OFFSET_Y) / 100.0f;
+	m_copyOffset->z = (float)obs_data_get_double(data, ST_COPIES_OFFSET_Z) / 100.0f;
+	m_copyRotation->x = (float)(obs_data_get_double(data, ST_COPIES_ROTATION_X) / 180.0f * PI);
+	m_copyRotation->y = (float)(obs_data_get_double(data, ST_COPIES_ROTATION_Y) / 180.0f * PI);
+	m_copyRotation->z = (float)(obs_data_get_double(data, ST_COPIES_ROTATION_Z) / 180.0f * PI);
+	m_copyScale = (float)obs_data_get_double(data, ST_COPIES_SCALE) / 100.0f;
 	m_isMeshUpdateRequired = true;
+
+	// Animation, only parsed again if the keyframes changed.
+	m_isAnimated = obs_data_get_bool(data, ST_ANIMATION);
+	// The values above replaced the animated ones, so apply the animation again.
+	m_animation.set_loop(obs_data_get_bool(data, ST_ANIMATION_LOOP));
+	const char* keyframes = obs_data_get_string(data, ST_ANIMATION_KEYFRAMES);
+	if (keyframes != m_animationKeyframes) {
+		m_animationKeyframes = keyframes;
+		parse_keyframes(m_animationKeyframes);
+	}
+}
+
+void Filter::Transform::Instance::parse_keyframes(std::string text) {
+	// Keyframe values use the same units as the properties.
+	struct parameter {
+		const char* name;
+		float_t* target;
+		float_t factor;
+	};
+	const parameter parameters[] = {
+		{ "position.x", &m_position->x, 1.0f / 100.0f },
+		{ "position.y", &m_position->y, 1.0f / 100.0f },
+		{ "position.z", &m_position->z, 1.0f / 100.0f },
+		{ "rotation.x", &m_rotation->x, float_t(PI / 180.0) },
+		{ "rotation.y", &m_rotation->y, float_t(PI / 180.0) },
+		{ "rotation.z", &m_rotation->z, float_t(PI / 180.0) },
+		{ "scale.x", &m_scale->x, 1.0f / 100.0f },
+		{ "scale.y", &m_scale->y, 1.0f / 100.0f },
+		{ "shear.x", &m_shear->x, 1.0f / 100.0f },
+		{ "shear.y", &m_shear->y, 1.0f / 100.0f },
+		{ "fov", &m_cameraFieldOfView, 1.0f },
+	};
+
+	std::vector<std::string> names;
+	m_animatedValues.clear();
+	for (const parameter& entry : parameters) {
+		names.push_back(entry.name);
+		m_animatedValues.push_back({ entry.target, entry.factor });
+	}
+
+	std::vector<std::string> errors;
+	m_animation.parse(text, names, errors);
+	for (std::string& error : errors) {
+		P_LOG_WARNING("<Filter::Transform> %s", error.c_str());
+	}
 }
 
 uint32_t Filter::Transform::Instance::get_width() {
@@ -359,7 +550,196 @@ void Filter::Transform::Instance::deactivate() {
 	m_isInactive = true;
 }
 
-void Filter::Transform::Instance::video_tick(float) {}
+void Filter::Transform::Instance::video_tick(float time) {
+	if (!m_isAnimated || m_animation.empty()) {
+		return;
+	}
+	if (!m_animation.step(time)) {
+		return;
+	}
+
+	for (size_t idx = 0; idx < m_animatedValues.size(); idx++) {
+		float_t value;
+		if (m_animation.evaluate(idx, value)) {
+			*m_animatedValues[idx].target = value * m_animatedValues[idx].factor;
+		}
+	}
+	m_isMeshUpdateRequired = true;
+}
+
+void Filter::Transform::Instance::calculate_transform(uint32_t baseW, uint32_t baseH, uint32_t copy,
+	matrix4* transform, float_t& width, float_t& height) {
+	float_t aspectRatioX = float_t(baseW) / float_t(baseH);
+	if (m_isCameraOrthographic)
+		aspectRatioX = 1.0;
+
+	// Rotation, combined as quaternions so the matrix is only built once.
+	float_t steps = float_t(copy);
+	util::quaternion qx = util::quaternion::from_axis_angle(1, 0, 0, m_rotation->x + m_copyRotation->x * steps);
+	util::quaternion qy = util::quaternion::from_axis_angle(0, 1, 0, m_rotation->y + m_copyRotation->y * steps);
+	util::quaternion qz = util::quaternion::from_axis_angle(0, 0, 1, m_rotation->z + m_copyRotation->z * steps);
+	util::quaternion rotation;
+	switch (m_rotationOrder) {
+		case RotationOrder::XYZ: // XYZ
+			rotation = util::combine(util::combine(qx, qy), qz);
+			break;
+		case RotationOrder::XZY: // XZY
+			rotation = util::combine(util::combine(qx, qz), qy);
+			break;
+		case RotationOrder::YXZ: // YXZ
+			rotation = util::combine(util::combine(qy, qx), qz);
+			break;
+		case RotationOrder::YZX: // YZX
+			rotation = util::combine(util::combine(qy, qz), qx);
+			break;
+		case RotationOrder::ZXY: // ZXY
+		default:
+			rotation = util::combine(util::combine(qz, qx), qy);
+			break;
+		case RotationOrder::ZYX: // ZYX
+			rotation = util::combine(util::combine(qz, qy), qx);
+			break;
+	}
+	util::matrix_from_quaternion(transform, rotation);
+	vec4_set(&transform->t,
+		m_position->x + m_copyOffset->x * steps,
+		m_position->y + m_copyOffset->y * steps,
+		m_position->z + m_copyOffset->z * steps,
+		1.0f);
+	if (copy > 0) {
+		// Scaling the rotation rows scales the vertex before it is rotated.
+		float_t copyScale = powf(m_copyScale, steps);
+		vec4_mulf(&transform->x, &transform->x, copyScale);
+		vec4_mulf(&transform->y, &transform->y, copyScale);
+		vec4_mulf(&transform->z, &transform->z, copyScale);
+	}
+
+	/// Calculate vertex position once only.
+	width = aspectRatioX * m_scale->x;
+	height = 1.0f * m_scale->y;
+}
+
+void Filter::Transform::Instance::calculate_corners(uint32_t baseW, uint32_t baseH, vec3 corners[4]) {
+	matrix4 ident;
+	float_t p_x, p_y;
+	calculate_transform(baseW, baseH, 0, &ident, p_x, p_y);
+
+	/// Corners in the order top left, top right, bottom left, bottom right.
+	vec3_set(&corners[0], -p_x + m_shear->x, -p_y - m_shear->y, 0);
+	vec3_set(&corners[1], p_x + m_shear->x, -p_y + m_shear->y, 0);
+	vec3_set(&corners[2], -p_x - m_shear->x, p_y - m_shear->y, 0);
+	vec3_set(&corners[3], p_x - m_shear->x, p_y + m_shear->y, 0);
+	util::transform_points(corners, corners, 4, &ident);
+}
+
+bool Filter::Transform::Instance::is_identity() {
+	return m_isCameraOrthographic
+		&& (m_position->x == 0) && (m_position->y == 0)
+		&& (m_rotation->x == 0) && (m_rotation->y == 0) && (m_rotation->z == 0)
+		&& (m_scale->x == 1) && (m_scale->y == 1)
+		&& (m_shear->x == 0) && (m_shear->y == 0)
+		&& (m_bendMode == BendMode::None) && (m_copies == 1);
+}
+
+bool Filter::Transform::Instance::update_mesh(uint32_t baseW, uint32_t baseH) {
+	// A flat quad looks the same at any subdivision, so only bends use the grid.
+	uint32_t gridX = 1, gridY = 1;
+	if (m_bendMode != BendMode::None) {
+		gridX = clamp(m_subdivisionX, 1u, 64u);
+		gridY = clamp(m_subdivisionY, 1u, 64u);
+	}
+	uint32_t columns = gridX + 1, rows = gridY + 1;
+	uint32_t count = columns * rows;
+	uint32_t copies = clamp(m_copies, 1u, 64u);
+
+	// Buffers only change with the grid size or number of copies. All copies
+	// share one buffer, so they are drawn with a single call.
+	if (!m_vertexHelper || (columns != m_meshColumns) || (rows != m_meshRows)
+		|| (copies != m_meshCopies)) {
+		delete m_vertexHelper;
+		m_vertexHelper = new gs::vertex_buffer(count * copies);
+		m_vertexHelper->set_uv_layers(1);
+		m_vertexHelper->resize(count * copies);
+
+		m_indexBuffer = std::make_unique<gs::index_buffer>(gridX * gridY * 6 * copies);
+		for (uint32_t copy = 0; copy < copies; copy++) {
+			uint32_t base = copy * count;
+			for (uint32_t y = 0; y < gridY; y++) {
+				for (uint32_t x = 0; x < gridX; x++) {
+					uint32_t i0 = base + y * columns + x, i1 = i0 + 1;
+					uint32_t i2 = i0 + columns, i3 = i2 + 1;
+					m_indexBuffer->insert(m_indexBuffer->end(), { i0, i1, i2, i1, i3, i2 });
+				}
+			}
+		}
+		m_indexBuffer->get();
+
+		m_meshColumns = columns;
+		m_meshRows = rows;
+		m_meshCopies = copies;
+	}
+
+	matrix4 transform;
+	float_t p_x, p_y;
+	calculate_transform(baseW, baseH, 0, &transform, p_x, p_y);
+
+	// Bends keep the arc length along the center lines, so the surface
+	// doesn't stretch there. The angle is the part of a full circle covered
+	// along x, the sphere uses the same radius along y.
+	float_t angle = 0;
+	if (m_bendMode != BendMode::None) {
+		angle = m_bendAmount * float_t(PI);
+	}
+	float_t radius = (fabsf(angle) > 0.0001f) ? (p_x / (angle / 2.0f)) : 0;
+
+	vec3* positions = m_vertexHelper->get_positions();
+	vec4* uvs = m_vertexHelper->get_uv_layer(0);
+	uint32_t* colors = m_vertexHelper->get_colors();
+	for (uint32_t y = 0, idx = 0; y < rows; y++) {
+		float_t v = float_t(y) / float_t(gridY);
+		float_t t = v * 2.0f - 1.0f;
+		for (uint32_t x = 0; x < columns; x++, idx++) {
+			float_t u = float_t(x) / float_t(gridX);
+			float_t s = u * 2.0f - 1.0f;
+
+			float_t px = s * p_x - t * m_shear->x;
+			float_t py = t * p_y + s * m_shear->y;
+			float_t pz = 0;
+			if ((radius != 0) && (m_bendMode == BendMode::Cylinder)) {
+				float_t phi = s * (angle / 2.0f);
+				px = radius * sinf(phi) - t * m_shear->x;
+				pz = radius * (1.0f - cosf(phi));
+			} else if ((radius != 0) && (m_bendMode == BendMode::Sphere)) {
+				// Longitude along x and latitude along y, every point is at the
+				// same distance from the center.
+				float_t phi = s * (angle / 2.0f);
+				float_t theta = t * p_y / radius;
+				px = radius * sinf(phi) * cosf(theta) - t * m_shear->x;
+				py = radius * sinf(theta) + s * m_shear->y;
+				pz = radius * (1.0f - cosf(phi) * cosf(theta));
+			}
+
+			vec3_set(&positions[idx], px, py, pz);
+			vec4_set(&uvs[idx], u, v, 0, 0);
+			colors[idx] = 0xFFFFFFFF;
+		}
+	}
+
+	// Copies reuse the untransformed grid of the first one.
+	for (uint32_t copy = copies - 1; copy > 0; copy--) {
+		matrix4 copyTransform;
+		calculate_transform(baseW, baseH, copy, &copyTransform, p_x, p_y);
+		memcpy(positions + copy * count, positions, sizeof(vec3) * count);
+		memcpy(uvs + copy * count, uvs, sizeof(vec4) * count);
+		memcpy(colors + copy * count, colors, sizeof(uint32_t) * count);
+		util::transform_points(positions + copy * count, positions + copy * count, count,
+			&copyTransform);
+	}
+	util::transform_points(positions, positions, count, &transform);
+
+	m_vertexBuffer = m_vertexHelper->update();
+	return m_vertexBuffer != nullptr;
+}
 
 void Filter::Transform::Instance::video_render(gs_effect_t *paramEffect) {
 	obs_source_t *parent = obs_filter_get_parent(m_sourceContext);
@@ -371,14 +751,58 @@ void Filter::Transform::Instance::video_render(gs_effect_t *paramEffect) {
 	// Skip rendering if our target, parent or context is not valid.
 	if (!target || !parent || !m_sourceContext
 		|| !baseW || !baseH
-		|| !m_texRender || !m_shapeRender
-		|| m_isInactive || m_isHidden) {
+		|| m_isInactive || m_isHidden
+		|| is_identity()) {
 		obs_source_skip_video_filter(m_sourceContext);
 		return;
 	}
 
 	gs_effect_t *alphaEffect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 
+	// Drawing happens with culling disabled, the caller's mode is restored
+	// after every draw.
+	gs_cull_mode cullMode = gs_get_cull_mode();
+
+	// An orthographic projection of the plane is a 2D affine transform, so
+	// the source can be drawn directly with that transform on the matrix
+	// stack, without any intermediate target of our own. Depth is flattened
+	// as there is no depth test anyway.
+	if (m_isCameraOrthographic && (m_bendMode == BendMode::None) && (m_copies == 1)) {
+		vec3 corners[4];
+		calculate_corners(baseW, baseH, corners);
+
+		// Maps source pixels onto the quad, and the camera's [-1, 1] onto the output.
+		float_t w = float_t(baseW), h = float_t(baseH);
+		vec3 o = corners[0], ex, ey;
+		vec3_sub(&ex, &corners[1], &corners[0]);
+		vec3_sub(&ey, &corners[2], &corners[0]);
+		matrix4 transform;
+		vec4_set(&transform.x, ex.x / 2.0f, (h * ex.y) / (2.0f * w), 0, 0);
+		vec4_set(&transform.y, (w * ey.x) / (2.0f * h), ey.y / 2.0f, 0, 0);
+		vec4_set(&transform.z, 0, 0, 1, 0);
+		vec4_set(&transform.t, (w / 2.0f) * (1.0f + o.x), (h / 2.0f) * (1.0f + o.y), 0, 1);
+
+		if (!obs_source_process_filter_begin(m_sourceContext, GS_RGBA,
+			OBS_ALLOW_DIRECT_RENDERING)) {
+			obs_source_skip_video_filter(m_sourceContext);
+			return;
+		}
+		gs_set_cull_mode(GS_NEITHER);
+		gs_matrix_push();
+		gs_matrix_mul(&transform);
+		obs_source_process_filter_end(m_sourceContext,
+			paramEffect ? paramEffect : alphaEffect,
+			baseW, baseH);
+		gs_matrix_pop();
+		gs_set_cull_mode(cullMode);
+		return;
+	}
+
+	// Only created once it is actually needed, the direct path above never is.
+	if (!m_texRender) {
+		m_texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	}
+
 	// Draw previous filters to texture.
 	gs_texrender_reset(m_texRender);
 	if (!gs_texrender_begin(m_texRender, baseW, baseH)) {
@@ -414,148 +838,78 @@ void Filter::Transform::Instance::video_render(gs_effect_t *paramEffect) {
 	}
 
 	gs_texrender_end(m_texRender);
+	gs_set_cull_mode(cullMode);
 	gs_texture* filterTexture = gs_texrender_get_texture(m_texRender);
 
 	// Update Mesh
 	if (m_isMeshUpdateRequired) {
-		float_t aspectRatioX = float_t(baseW) / float_t(baseH);
-		if (m_isCameraOrthographic)
-			aspectRatioX = 1.0;
-
-		// Mesh
-		matrix4 ident;
-		matrix4_identity(&ident);
-		switch (m_rotationOrder) {
-			case RotationOrder::XYZ: // XYZ
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				break;
-			case RotationOrder::XZY: // XZY
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				break;
-			case RotationOrder::YXZ: // YXZ
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				break;
-			case RotationOrder::YZX: // YZX
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				break;
-			case RotationOrder::ZXY: // ZXY
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				break;
-			case RotationOrder::ZYX: // ZYX
-				matrix4_rotate_aa4f(&ident, &ident, 0, 0, 1, m_rotation->z);
-				matrix4_rotate_aa4f(&ident, &ident, 0, 1, 0, m_rotation->y);
-				matrix4_rotate_aa4f(&ident, &ident, 1, 0, 0, m_rotation->x);
-				break;
-		}
-		matrix4_translate3f(&ident, &ident, m_position->x, m_position->y, m_position->z);
-
-		/// Calculate vertex position once only.
-		float_t p_x = aspectRatioX * m_scale->x;
-		float_t p_y = 1.0f * m_scale->y;
-
-		/// Generate mesh
-		{
-			gs::vertex vtx = m_vertexHelper->at(0);
-			*vtx.color = 0xFFFFFFFF;
-			vec4_set(vtx.uv[0], 0, 0, 0, 0);
-			vec3_set(vtx.position, 
-				-p_x + m_shear->x, 
-				-p_y - m_shear->y, 0);
-			vec3_transform(vtx.position, vtx.position, &ident);
-		}
-		{
-			gs::vertex vtx = m_vertexHelper->at(1);
-			*vtx.color = 0xFFFFFFFF;
-			vec4_set(vtx.uv[0], 1, 0, 0, 0);
-			vec3_set(vtx.position,
-				p_x + m_shear->x,
-				-p_y + m_shear->y, 0);
-			vec3_transform(vtx.position, vtx.position, &ident);
-		}
-		{
-			gs::vertex vtx = m_vertexHelper->at(2);
-			*vtx.color = 0xFFFFFFFF;
-			vec4_set(vtx.uv[0], 0, 1, 0, 0);
-			vec3_set(vtx.position,
-				-p_x - m_shear->x,
-				p_y - m_shear->y, 0);
-			vec3_transform(vtx.position, vtx.position, &ident);
-		}
-		{
-			gs::vertex vtx = m_vertexHelper->at(3);
-			*vtx.color = 0xFFFFFFFF;
-			vec4_set(vtx.uv[0], 1, 1, 0, 0);
-			vec3_set(vtx.position,
-				p_x - m_shear->x,
-				p_y + m_shear->y, 0);
-			vec3_transform(vtx.position, vtx.position, &ident);
-		}
-
-		m_vertexBuffer = m_vertexHelper->update();
-		if (!m_vertexBuffer) {
+		if (!update_mesh(baseW, baseH)) {
 			obs_source_skip_video_filter(m_sourceContext);
 			return;
 		}
 		m_isMeshUpdateRequired = false;
 	}
+	gs_indexbuffer_t* indexBuffer = m_indexBuffer->get(false);
+	uint32_t indexCount = (uint32_t)m_indexBuffer->size();
 
-	// Draw shape to texture
-	gs_texrender_reset(m_shapeRender);
-	if (gs_texrender_begin(m_shapeRender, baseW, baseH)) {
-		if (m_isCameraOrthographic) {
-			gs_ortho(-1.0, 1.0, -1.0, 1.0, -farZ, farZ);
-		} else {
-			gs_perspective(m_cameraFieldOfView,
-				float_t(baseW) / float_t(baseH), nearZ, farZ);
-			// Fix camera pointing at -Z instead of +Z.
-			gs_matrix_scale3f(1.0, 1.0, -1.0);
-			// Move backwards so we can actually see stuff.
-			gs_matrix_translate3f(0, 0, 1.0);
-		}
-
-		// Rendering
-		vec4 black;
-		vec4_zero(&black);
-		gs_clear(GS_CLEAR_COLOR | GS_CLEAR_DEPTH, &black, farZ, 0);
+	// Bent or copied meshes with an orthographic camera map [-1, 1] straight
+	// onto the output, with depth flattened.
+	if (m_isCameraOrthographic) {
+		gs_reset_blend_state();
 		gs_set_cull_mode(GS_NEITHER);
-		gs_enable_blending(false);
 		gs_enable_depth_test(false);
-		gs_depth_function(gs_depth_test::GS_ALWAYS);
 		gs_enable_stencil_test(false);
-		gs_enable_stencil_write(false);
 		gs_enable_color(true, true, true, true);
+
+		gs_matrix_push();
+		gs_matrix_translate3f(float_t(baseW) / 2.0f, float_t(baseH) / 2.0f, 0);
+		gs_matrix_scale3f(float_t(baseW) / 2.0f, float_t(baseH) / 2.0f, 0);
 		while (gs_effect_loop(alphaEffect, "Draw")) {
 			gs_effect_set_texture(
 				gs_effect_get_param_by_name(alphaEffect,
 					"image"), filterTexture);
 			gs_load_vertexbuffer(m_vertexBuffer);
-			gs_load_indexbuffer(NULL);
-			gs_draw(GS_TRISTRIP, 0, 4);
+			gs_load_indexbuffer(indexBuffer);
+			gs_draw(GS_TRIS, 0, indexCount);
 		}
-
-		gs_texrender_end(m_shapeRender);
-	} else {
-		obs_source_skip_video_filter(m_sourceContext);
+		gs_matrix_pop();
+		gs_set_cull_mode(cullMode);
 		return;
 	}
-	gs_texture* shapeTexture = gs_texrender_get_texture(m_shapeRender);
 
-	// Draw final shape
+	// A perspective camera is drawn directly as well. The perspective
+	// projection followed by the mapping from [-1, 1] to output pixels, with
+	// depth flattened, is a single homogeneous matrix: the mapping is affine
+	// and thus commutes with the perspective divide. For a symmetric frustum
+	// the depth range cancels out entirely.
+	float_t w = float_t(baseW), h = float_t(baseH);
+	float_t focal = float_t(1.0 / tan(m_cameraFieldOfView / 180.0 * PI / 2.0));
+	matrix4 projection;
+	vec4_set(&projection.x, focal * h / 2.0f, 0, 0, 0);
+	vec4_set(&projection.y, 0, focal * h / 2.0f, 0, 0);
+	vec4_set(&projection.z, w / 2.0f, h / 2.0f, 0, 1);
+	vec4_set(&projection.t, 0, 0, 0, 0);
+
 	gs_reset_blend_state();
+	gs_set_cull_mode(GS_NEITHER);
 	gs_enable_depth_test(false);
+	gs_enable_stencil_test(false);
+	gs_enable_color(true, true, true, true);
+
+	gs_matrix_push();
+	gs_matrix_mul(&projection);
+	// Fix camera pointing at -Z instead of +Z.
+	gs_matrix_scale3f(1.0, 1.0, -1.0);
+	// Move backwards so we can actually see stuff.
+	gs_matrix_translate3f(0, 0, 1.0);
 	while (gs_effect_loop(alphaEffect, "Draw")) {
-		gs_effect_set_texture(gs_effect_get_param_by_name(alphaEffect,
-			"image"), shapeTexture);
-		gs_draw_sprite(shapeTexture, 0, 0, 0);
+		gs_effect_set_texture(
+			gs_effect_get_param_by_name(alphaEffect,
+				"image"), filterTexture);
+		gs_load_vertexbuffer(m_vertexBuffer);
+		gs_load_indexbuffer(indexBuffer);
+		gs_draw(GS_TRIS, 0, indexCount);
 	}
+	gs_matrix_pop();
+	gs_set_cull_mode(cullMode);
 }
@@ -19,8 +19,11 @@
 
 #pragma once
 #include "plugin.h"
+#include "gs-indexbuffer.h"
 #include "gs-vertexbuffer.h"
+#include "util-animation.h"
 #include <memory>
+#include <vector>
 
 namespace Filter {
 	class Transform {
@@ -63,11 +66,21 @@ namespace Filter {
 			void video_tick(float);
 			void video_render(gs_effect_t*);
 
+			private:
+			void calculate_transform(uint32_t baseW, uint32_t baseH, uint32_t copy, matrix4* transform,
+				float_t& width, float_t& height);
+			void calculate_corners(uint32_t baseW, uint32_t baseH, vec3 corners[4]);
+			bool update_mesh(uint32_t baseW, uint32_t baseH);
+			void parse_keyframes(std::string text);
+			bool is_identity();
+
 			private:
 			obs_source_t *m_sourceContext;
 			gs::vertex_buffer *m_vertexHelper;
 			gs_vertbuffer_t *m_vertexBuffer;
-			gs_texrender_t *m_texRender, *m_shapeRender;
+			std::unique_ptr<gs::index_buffer> m_indexBuffer;
+			uint32_t m_meshColumns, m_meshRows, m_meshCopies;
+			gs_texrender_t *m_texRender;
 
 			// Camera
 			bool m_isCameraOrthographic;
@@ -77,6 +90,27 @@ namespace Filter {
 			bool m_isInactive, m_isHidden;
 			bool m_isMeshUpdateRequired;
 
+			// Mesh
+			uint32_t m_bendMode;
+			float_t m_bendAmount;
+			uint32_t m_subdivisionX, m_subdivisionY;
+
+			// Copies, each one adds the offset and rotation once more and
+			// multiplies the scale again.
+			uint32_t m_copies;
+			float_t m_copyScale;
+
+			// Animation, tracks write straight into the values below.
+			// Indexed like the tracks of the timeline.
+			struct animated_value {
+				float_t* target;
+				float_t factor;
+			};
+			bool m_isAnimated;
+			std::string m_animationKeyframes;
+			util::animation::timeline m_animation;
+			std::vector<animated_value> m_animatedValues;
+
 			// 3D Information
 			uint32_t m_rotationOrder;
 			struct {
@@ -84,6 +118,8 @@ namespace Filter {
 				std::unique_ptr<util::vec3a> m_rotation;
 				std::unique_ptr<util::vec3a> m_scale;
 				std::unique_ptr<util::vec3a> m_shear;
+				std::unique_ptr<util::vec3a> m_copyOffset;
+				std::unique_ptr<util::vec3a> m_copyRotation;
 			};
 		};
 	};
@@ -16,9 +16,22 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-effect-source.h"
+#include <algorithm>
+#include <ios>
+#include <mutex>
+#include <regex>
+#include <sys/stat.h>
 #include "strings.h"
+#include "util-allocation.h"
+#include "util-file.h"
+#include "util-hash.h"
+#include "util-math.h"
 #include <util/platform.h>
-#include <fstream>
+
+// Compiled effects, keyed by content hash. Identical shaders share one effect,
+// which is safe as all parameters are re-applied before every draw.
+static std::mutex effect_cache_lock;
+static std::map<uint64_t, std::weak_ptr<gs::effect>> effect_cache;
 
 bool gfx::effect_source::property_type_modified(void*, obs_properties_t* props, obs_property_t*, obs_data_t* sett) {
 	switch ((InputTypes)obs_data_get_int(sett, D_TYPE)) {
@@ -52,8 +65,238 @@ bool gfx::effect_source::property_input_modified(void* obj, obs_properties_t*, o
 	return reinterpret_cast<gfx::effect_source*>(obj)->test_for_updates(text, file);
 }
 
+bool gfx::effect_source::property_texture_type_modified(void*, obs_properties_t* props, obs_property_t* prop, obs_data_t* sett) {
+	std::string name = obs_property_name(prop);
+	bool is_source = ((TextureTypes)obs_data_get_int(sett, name.c_str()) == TextureTypes::Source);
+	obs_property_set_visible(obs_properties_get(props, (name + ".File").c_str()), !is_source);
+	obs_property_set_visible(obs_properties_get(props, (name + ".Source").c_str()), is_source);
+	return true;
+}
+
+// Removes annotations from techniques, as libobs can't parse them, and returns
+// them by technique name. For example 'technique Pass0 < float Scale = 0.5; >'.
+static gfx::effect_source::annotations_t strip_technique_annotations(std::string& text) {
+	static const std::regex technique_regex("technique\\s+(\\w+)\\s*<([^>]*)>");
+	static const std::regex annotation_regex("\\w+\\s+(\\w+)\\s*=\\s*\"?([^;\"]*)\"?\\s*;");
+
+	gfx::effect_source::annotations_t annotations;
+	std::string result;
+	auto last = text.cbegin();
+	for (std::sregex_iterator iter(text.cbegin(), text.cend(), technique_regex), end; iter != end; iter++) {
+		auto& values = annotations[(*iter)[1].str()];
+		std::string body = (*iter)[2].str();
+		for (std::sregex_iterator aiter(body.cbegin(), body.cend(), annotation_regex); aiter != end; aiter++) {
+			values.insert_or_assign((*aiter)[1].str(), (*aiter)[2].str());
+		}
+
+		result.append(last, (*iter)[0].first);
+		result.append("technique " + (*iter)[1].str());
+		last = (*iter)[0].second;
+	}
+	if (annotations.size() > 0) {
+		result.append(last, text.cend());
+		text = std::move(result);
+	}
+	return annotations;
+}
+
+static gs_color_format format_from_string(std::string format) {
+	std::pair<const char*, gs_color_format> formats[] = {
+		{ "RGBA", GS_RGBA },
+		{ "BGRA", GS_BGRA },
+		{ "R8", GS_R8 },
+		{ "R10G10B10A2", GS_R10G10B10A2 },
+		{ "RGBA16", GS_RGBA16 },
+		{ "R16", GS_R16 },
+		{ "RGBA16F", GS_RGBA16F },
+		{ "RGBA32F", GS_RGBA32F },
+		{ "RG16F", GS_RG16F },
+		{ "RG32F", GS_RG32F },
+		{ "R16F", GS_R16F },
+		{ "R32F", GS_R32F },
+	};
+	for (auto& kv : formats) {
+		if (format == kv.first)
+			return kv.second;
+	}
+	return GS_RGBA;
+}
+
+static bool add_source_to_list(void* ptr, obs_source_t* src) {
+	obs_property_t* p = (obs_property_t*)ptr;
+	obs_property_list_add_string(p, obs_source_get_name(src), obs_source_get_name(src));
+	return true;
+}
+
+bool gfx::effect_source::compile_effect(const char* code, size_t size, std::string name) {
+	uint64_t hash = util::hash(code, size);
+	if (m_shader.effect && (m_shader.hash == hash)) {
+		// Content did not change, so there is nothing to recompile.
+		return false;
+	}
+	m_shader.hash = hash;
+
+	std::string text(code, size);
+	annotations_t annotations = strip_technique_annotations(text);
+
+	std::unique_lock<std::mutex> ulock(effect_cache_lock);
+	auto entry = effect_cache.find(hash);
+	if (entry != effect_cache.end()) {
+		m_shader.effect = entry->second.lock();
+		if (m_shader.effect) {
+			build_passes(annotations);
+			return true;
+		}
+	}
+
+	try {
+		m_shader.effect = std::make_shared<gs::effect>(text, name);
+		effect_cache.insert_or_assign(hash, m_shader.effect);
+	} catch (std::runtime_error& ex) {
+		P_LOG_ERROR("<gfx::effect_source> Compiling effect '%s' failed with error(s): %s", name.c_str(), ex.what());
+		m_shader.effect = nullptr;
+		effect_cache.erase(hash);
+	}
+	build_passes(annotations);
+
+	// Drop entries that no longer have any users.
+	for (auto iter = effect_cache.begin(); iter != effect_cache.end();) {
+		if (iter->second.expired()) {
+			iter = effect_cache.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	return true;
+}
+
+void gfx::effect_source::build_passes(annotations_t& annotations) {
+	m_passes.clear();
+	m_drawInputs.clear();
+	m_passTargets.clear();
+	if (!m_shader.effect)
+		return;
+
+	// Find all passes, stopping at the first gap.
+	std::map<std::string, size_t> indexes;
+	for (size_t idx = 0;; idx++) {
+		pass ps;
+		ps.name = "Pass" + std::to_string(idx);
+		if (!gs_effect_get_technique(m_shader.effect->get_object(), ps.name.c_str()))
+			break;
+
+		auto& values = annotations[ps.name];
+		if (values.count("Scale")) {
+			ps.scale = clamp(float_t(atof(values["Scale"].c_str())), 1.0f / 64.0f, 1.0f);
+		}
+		if (values.count("Format")) {
+			ps.format = format_from_string(values["Format"]);
+		}
+		indexes.insert_or_assign(ps.name, idx);
+		m_passes.push_back(ps);
+	}
+
+	// Each pass reads the previous one, unless it declares its inputs.
+	auto parse_inputs = [&indexes, &annotations](std::string technique, size_t index) {
+		std::vector<size_t> inputs;
+		auto& values = annotations[technique];
+		if (values.count("Inputs") == 0) {
+			if (index > 0)
+				inputs.push_back(index - 1);
+			return inputs;
+		}
+
+		static const std::regex name_regex("\\w+");
+		std::string list = values["Inputs"];
+		for (std::sregex_iterator iter(list.cbegin(), list.cend(), name_regex), end; iter != end; iter++) {
+			auto kv = indexes.find(iter->str());
+			if ((kv == indexes.end()) || (kv->second >= index)) {
+				P_LOG_WARNING("<gfx::effect_source> Technique '%s' can't read '%s', only earlier passes.",
+					technique.c_str(), iter->str().c_str());
+				continue;
+			}
+			inputs.push_back(kv->second);
+		}
+		return inputs;
+	};
+	for (size_t idx = 0; idx < m_passes.size(); idx++) {
+		m_passes[idx].inputs = parse_inputs(m_passes[idx].name, idx);
+	}
+	m_drawInputs = parse_inputs("Draw", m_passes.size());
+
+	// A pass output lives until the last pass reading it, after which its
+	// render target is handed to the next pass with the same format.
+	std::vector<size_t> last_use(m_passes.size());
+	for (size_t idx = 0; idx < m_passes.size(); idx++) {
+		last_use[idx] = idx;
+		for (size_t reader = idx + 1; reader <= m_passes.size(); reader++) {
+			auto& inputs = (reader < m_passes.size()) ? m_passes[reader].inputs : m_drawInputs;
+			if (std::find(inputs.begin(), inputs.end(), idx) != inputs.end())
+				last_use[idx] = reader;
+		}
+	}
+
+	std::vector<uint32_t> formats(m_passes.size());
+	for (size_t idx = 0; idx < m_passes.size(); idx++) {
+		formats[idx] = uint32_t(m_passes[idx].format);
+	}
+	std::vector<uint32_t> target_formats;
+	std::vector<size_t> targets = util::assign_slots(formats, last_use, target_formats);
+	for (size_t idx = 0; idx < m_passes.size(); idx++) {
+		m_passes[idx].target = targets[idx];
+	}
+
+	for (uint32_t format : target_formats) {
+		m_passTargets.push_back(std::make_shared<gs::rendertarget>(gs_color_format(format), GS_ZS_NONE));
+	}
+}
+
+void gfx::effect_source::bind_pass_inputs(std::vector<size_t>& inputs) {
+	for (size_t idx : inputs) {
+		pass& ps = m_passes[idx];
+		if (!m_shader.effect->has_parameter(ps.name, gs::effect_parameter::type::Texture))
+			continue;
+
+		std::shared_ptr<gs::texture> tex;
+		m_passTargets[ps.target]->get_texture(tex);
+		m_shader.effect->get_parameter(ps.name).set_texture(tex);
+		if (m_shader.effect->has_parameter(ps.name + "_Size", gs::effect_parameter::type::Float2)) {
+			m_shader.effect->get_parameter(ps.name + "_Size").set_float2(
+				float_t(tex->get_width()),
+				float_t(tex->get_height()));
+		}
+		if (m_shader.effect->has_parameter(ps.name + "_SizeI"/*, gs::effect_parameter::type::Integer2*/)) {
+			m_shader.effect->get_parameter(ps.name + "_SizeI").set_int2(
+				tex->get_width(),
+				tex->get_height());
+		}
+		if (m_shader.effect->has_parameter(ps.name + "_Texel", gs::effect_parameter::type::Float2)) {
+			m_shader.effect->get_parameter(ps.name + "_Texel").set_float2(
+				float_t(1.0 / tex->get_width()),
+				float_t(1.0 / tex->get_height()));
+		}
+	}
+}
+
+bool gfx::effect_source::is_pass_parameter(std::string name, gs::effect_parameter::type type) {
+	if (type != gs::effect_parameter::type::Texture)
+		return false;
+	for (auto& ps : m_passes) {
+		if (ps.name == name)
+			return true;
+	}
+	return false;
+}
+
 gfx::effect_source::effect_source(obs_data_t* data, obs_source_t* owner) {
 	m_source = owner;
+	m_shader.hash = 0;
+	m_shader.file_info.time_updated = 0;
+	m_shader.file_info.time_create = 0;
+	m_shader.file_info.time_modified = 0;
+	m_shader.file_info.file_size = 0;
+	m_shader.file_info.modified = false;
+	m_inputScale = 1.0f;
 	m_timeExisting = 0;
 	m_timeActive = 0;
 
@@ -100,6 +343,9 @@ void gfx::effect_source::get_properties(obs_properties_t* properties) {
 		bfree(tmp_path);
 	}
 
+	p = obs_properties_add_float_slider(properties, D_INPUT_SCALE, P_TRANSLATE(T_INPUT_SCALE), 1.0, 100.0, 0.01);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(T_INPUT_SCALE)));
+
 	// ToDo: Place updated properties here or somewhere else?
 	for (auto prm : m_parameters) {
 		if (prm.first.second == gs::effect_parameter::type::Boolean) {
@@ -116,6 +362,20 @@ void gfx::effect_source::get_properties(obs_properties_t* properties) {
 			for (size_t idx = 0; idx <= cnt; idx++) {
 				obs_properties_add_float(properties, prm.second->ui.names[idx], prm.second->ui.descs[idx], FLT_MIN, FLT_MAX, 0.01);
 			}
+		} else if (prm.first.second == gs::effect_parameter::type::Texture) {
+			p = obs_properties_add_list(properties, prm.second->ui.names[0], prm.second->ui.descs[0], OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+			obs_property_list_add_int(p, P_TRANSLATE(T_TEXTURE_TYPE_FILE), (long long)TextureTypes::File);
+			obs_property_list_add_int(p, P_TRANSLATE(T_TEXTURE_TYPE_SOURCE), (long long)TextureTypes::Source);
+			obs_property_set_modified_callback2(p, property_texture_type_modified, this);
+
+			obs_properties_add_path(properties, prm.second->ui.names[1], prm.second->ui.descs[1], OBS_PATH_FILE,
+				"Images (*.bmp *.jpg *.jpeg *.tga *.gif *.png)", nullptr);
+
+			p = obs_properties_add_list(properties, prm.second->ui.names[2], prm.second->ui.descs[2], OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+			obs_enum_sources(add_source_to_list, p);
+
+			obs_properties_add_bool(properties, prm.second->ui.names[3], prm.second->ui.descs[3]);
+			obs_properties_add_text(properties, prm.second->ui.names[4], prm.second->ui.descs[4], OBS_TEXT_DEFAULT);
 		}
 	}
 }
@@ -124,6 +384,7 @@ void gfx::effect_source::get_defaults(obs_data_t* data) {
 	obs_data_set_default_int(data, D_TYPE, (long long)InputTypes::Text);
 	obs_data_set_default_string(data, D_INPUT_TEXT, "");
 	obs_data_set_default_string(data, D_INPUT_FILE, "");
+	obs_data_set_default_double(data, D_INPUT_SCALE, 100.0);
 }
 
 void gfx::effect_source::update(obs_data_t* data) {
@@ -139,6 +400,8 @@ void gfx::effect_source::update(obs_data_t* data) {
 		test_for_updates(nullptr, path);
 	}
 
+	m_inputScale = float_t(obs_data_get_double(data, D_INPUT_SCALE) / 100.0);
+
 	update_parameters(data);
 
 	obs_data_release(data);
@@ -149,15 +412,7 @@ bool gfx::effect_source::test_for_updates(const char* text, const char* path) {
 	if (text != nullptr) {
 		if (text != m_shader.text) {
 			m_shader.text = text;
-			is_shader_different = true;
-		}
-
-		if (is_shader_different) {
-			try {
-				m_shader.effect = std::make_unique<gs::effect>(m_shader.text, "Text");
-			} catch (...) {
-				m_shader.effect = nullptr;
-			}
+			is_shader_different = compile_effect(m_shader.text.data(), m_shader.text.size(), "Text");
 		}
 	} else if (path != nullptr) {
 		if (path != this->m_shader.path) {
@@ -194,25 +449,15 @@ bool gfx::effect_source::test_for_updates(const char* text, const char* path) {
 
 		if (is_shader_different || m_shader.file_info.modified) {
 			// gs_effect_create_from_file caches results, which is bad for us.
-			std::vector<char> content;
-			std::ifstream fs(m_shader.path.c_str(), std::ios::binary);
-
-			if (fs.good()) {
-				size_t beg = fs.tellg();
-				fs.seekg(0, std::ios::end);
-				size_t sz = size_t(fs.tellg()) - beg;
-				content.resize(sz + 1);
-				fs.seekg(0, std::ios::beg);
-				fs.read(content.data(), sz);
-				fs.close();
-				content[sz] = '\0';
-
-				try {
-					m_shader.effect = std::make_unique<gs::effect>(std::string(content.data()), m_shader.path);
-				} catch (...) {
-					m_shader.effect = nullptr;
-				}
+			// Map the file where that is safe, as most of the time the
+			// content is unchanged and only needs to be hashed.
+			try {
+				util::mapped_file file(m_shader.path);
+				is_shader_different = compile_effect(file.data(), file.size(), m_shader.path);
+			} catch (std::ios_base::failure&) {
+				is_shader_different = false;
 			}
+			m_shader.file_info.modified = false;
 		}
 	}
 
@@ -228,7 +473,8 @@ bool gfx::effect_source::test_for_updates(const char* text, const char* path) {
 				ident.first = effect_param.get_name();
 				ident.second = effect_param.get_type();
 
-				if (is_special_parameter(ident.first, ident.second))
+				if (is_pass_parameter(ident.first, ident.second)
+					|| is_special_parameter(ident.first, ident.second))
 					continue;
 
 				auto entry = m_parameters.find(ident);
@@ -335,6 +581,44 @@ bool gfx::effect_source::test_for_updates(const char* text, const char* path) {
 							off += ui_desc[idx].size() + 1;
 						}
 
+						param = std::dynamic_pointer_cast<parameter>(nparam);
+					} else if (ident.second == gs::effect_parameter::type::Texture) {
+						std::shared_ptr<texture_parameter> nparam = std::make_shared<texture_parameter>();
+
+						std::string ui_name[5], ui_desc[5];
+						ui_name[0] = ident.first;
+						ui_desc[0] = ident.first;
+						ui_name[1] = ident.first + ".File";
+						ui_desc[1] = ident.first + " (" + P_TRANSLATE(T_TEXTURE_TYPE_FILE) + ")";
+						ui_name[2] = ident.first + ".Source";
+						ui_desc[2] = ident.first + " (" + P_TRANSLATE(T_TEXTURE_TYPE_SOURCE) + ")";
+						ui_name[3] = ident.first + ".Resample";
+						ui_desc[3] = ident.first + " (" + P_TRANSLATE(T_TEXTURE_RESAMPLE) + ")";
+						ui_name[4] = ident.first + ".Resample.Size";
+						ui_desc[4] = ident.first + " (" + P_TRANSLATE(T_TEXTURE_RESAMPLE_SIZE) + ")";
+
+						size_t bufsize = 0;
+						for (size_t idx = 0; idx < 5; idx++) {
+							bufsize += ui_name[idx].size() + 1;
+							bufsize += ui_desc[idx].size() + 1;
+						}
+
+						nparam->ui.names.resize(5);
+						nparam->ui.descs.resize(5);
+
+						nparam->ui.buffer.resize(bufsize);
+						memset(nparam->ui.buffer.data(), 0, bufsize);
+						size_t off = 0;
+						for (size_t idx = 0; idx < 5; idx++) {
+							memcpy(nparam->ui.buffer.data() + off, ui_name[idx].c_str(), ui_name[idx].size());
+							nparam->ui.names[idx] = nparam->ui.buffer.data() + off;
+							off += ui_name[idx].size() + 1;
+
+							memcpy(nparam->ui.buffer.data() + off, ui_desc[idx].c_str(), ui_desc[idx].size());
+							nparam->ui.descs[idx] = nparam->ui.buffer.data() + off;
+							off += ui_desc[idx].size() + 1;
+						}
+
 						param = std::dynamic_pointer_cast<parameter>(nparam);
 					} else {
 
@@ -371,6 +655,73 @@ void gfx::effect_source::update_parameters(obs_data_t* data) {
 			for (size_t idx = 0; idx < prm.second->ui.names.size(); idx++) {
 				param->value[idx] = obs_data_get_double(data, prm.second->ui.names[idx]);
 			}
+		} else if (prm.first.second == gs::effect_parameter::type::Texture) {
+			auto param = std::static_pointer_cast<texture_parameter>(prm.second);
+			param->isSource = ((TextureTypes)obs_data_get_int(data, prm.second->ui.names[0]) == TextureTypes::Source);
+
+			std::string path = obs_data_get_string(data, prm.second->ui.names[1]);
+			if (path != param->file.path) {
+				// Loaded by check_textures() on the next tick.
+				param->file.path = path;
+				param->file.image = nullptr;
+				param->file.pending = nullptr;
+				param->file.info.time_updated = 0;
+				param->file.info.modified = true;
+			}
+
+			std::string name = obs_data_get_string(data, prm.second->ui.names[2]);
+			if (name != param->source.name) {
+				param->source.name = name;
+				param->source.tex = nullptr;
+				if (!name.empty()) {
+					try {
+						param->source.tex = std::make_shared<gfx::source_texture>(name, m_source);
+					} catch (std::exception& ex) {
+						P_LOG_ERROR("<gfx::effect_source> Using source '%s' for texture '%s' failed: %s",
+							name.c_str(), param->name.c_str(), ex.what());
+					}
+				}
+			}
+
+			param->resample.doResample = obs_data_get_bool(data, prm.second->ui.names[3]);
+			auto size = util::SizeFromString(obs_data_get_string(data, prm.second->ui.names[4]));
+			param->resample.resolution.first = uint32_t(clamp(size.first, 1, 16384));
+			param->resample.resolution.second = uint32_t(clamp(size.second, 1, 16384));
+		}
+	}
+}
+
+void gfx::effect_source::check_textures(float_t time) {
+	for (auto prm : m_parameters) {
+		if (prm.first.second != gs::effect_parameter::type::Texture)
+			continue;
+
+		auto param = std::static_pointer_cast<texture_parameter>(prm.second);
+		if (param->isSource || param->file.path.empty())
+			continue;
+
+		// Don't look at the file more often than necessary, unless it was just changed.
+		param->file.info.time_updated -= time;
+		if ((param->file.info.time_updated > 0) && !param->file.info.modified)
+			continue;
+		param->file.info.time_updated = 0.5f;
+
+		struct stat stats;
+		if (os_stat(param->file.path.c_str(), &stats) != 0)
+			continue;
+
+		param->file.info.modified = param->file.info.modified
+			| (param->file.info.time_create != stats.st_ctime)
+			| (param->file.info.time_modified != stats.st_mtime)
+			| (param->file.info.file_size != (size_t)stats.st_size);
+		param->file.info.time_create = stats.st_ctime;
+		param->file.info.time_modified = stats.st_mtime;
+		param->file.info.file_size = stats.st_size;
+
+		if (param->file.info.modified) {
+			// Decoding happens in the background, keep using the old image until it is done.
+			param->file.info.modified = false;
+			param->file.pending = gfx::texture_cache::load(param->file.path);
 		}
 	}
 }
@@ -412,6 +763,81 @@ void gfx::effect_source::apply_parameters() {
 					param->param->set_float4(param->value[0], param->value[1], param->value[2], param->value[3]);
 					break;
 			}
+		} else if (prm.first.second == gs::effect_parameter::type::Texture) {
+			auto param = std::static_pointer_cast<texture_parameter>(prm.second);
+
+			std::shared_ptr<gs::texture> tex;
+			if (param->isSource) {
+				if (param->source.tex) {
+					obs_source_t* src = param->source.tex->get_object();
+					uint32_t width = obs_source_get_width(src), height = obs_source_get_height(src);
+					try {
+						tex = param->source.tex->render(width, height);
+					} catch (...) {
+						tex = nullptr;
+					}
+				}
+			} else {
+				// A failed decode keeps the old image until the file changes again.
+				if (param->file.pending && param->file.pending->has_failed()) {
+					param->file.pending = nullptr;
+				} else if (param->file.pending && param->file.pending->is_decoded()) {
+					param->file.image = param->file.pending;
+					param->file.pending = nullptr;
+				}
+				if (param->file.image) {
+					tex = param->file.image->get_texture();
+				}
+			}
+
+			if (tex && param->resample.doResample) {
+				uint32_t width = param->resample.resolution.first, height = param->resample.resolution.second;
+				if (!param->resample.rt) {
+					param->resample.rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+					param->resample.input.reset();
+				}
+				if (param->isSource || (param->resample.input.lock() != tex)
+					|| (param->resample.size != param->resample.resolution)) {
+					param->resample.input = tex;
+					param->resample.size = param->resample.resolution;
+
+					auto op = param->resample.rt->render(width, height);
+					vec4 black; vec4_zero(&black);
+					gs_ortho(0, (float_t)width, 0, (float_t)height, 0, 1);
+					gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+					gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+					gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), tex->get_object());
+					while (gs_effect_loop(effect, "Draw")) {
+						gs_draw_sprite(tex->get_object(), 0, width, height);
+					}
+				}
+				param->resample.rt->get_texture(tex);
+			} else {
+				param->resample.rt = nullptr;
+				param->resample.input.reset();
+			}
+
+			param->param->set_texture(tex ? tex->get_object() : nullptr);
+			if (!tex)
+				continue;
+
+			std::string name = param->name;
+			if (m_shader.effect->has_parameter(name + "_Size", gs::effect_parameter::type::Float2)) {
+				m_shader.effect->get_parameter(name + "_Size").set_float2(
+					float_t(tex->get_width()),
+					float_t(tex->get_height()));
+			}
+			if (m_shader.effect->has_parameter(name + "_SizeI"/*, gs::effect_parameter::type::Integer2*/)) {
+				m_shader.effect->get_parameter(name + "_SizeI").set_int2(
+					tex->get_width(),
+					tex->get_height());
+			}
+			if (m_shader.effect->has_parameter(name + "_Texel", gs::effect_parameter::type::Float2)) {
+				m_shader.effect->get_parameter(name + "_Texel").set_float2(
+					float_t(1.0 / tex->get_width()),
+					float_t(1.0 / tex->get_height()));
+			}
 		}
 	}
 }
@@ -444,6 +870,8 @@ void gfx::effect_source::video_tick(float time) {
 	// File Timer
 	m_shader.file_info.time_updated -= time;
 
+	check_textures(time);
+
 	video_tick_impl(time);
 }
 
@@ -472,12 +900,6 @@ void gfx::effect_source::video_render(gs_effect_t* parent_effect) {
 		obs_source_skip_video_filter(m_source);
 		return;
 	}
-	if (m_shader.effect->has_parameter("ViewSize", gs::effect_parameter::type::Float2)) {
-		m_shader.effect->get_parameter("ViewSize").set_float2(float_t(viewW), float_t(viewH));
-	}
-	if (m_shader.effect->has_parameter("ViewSizeI"/*, gs::effect_parameter::type::Integer2*/)) {
-		m_shader.effect->get_parameter("ViewSizeI").set_int2(int32_t(viewW), int32_t(viewH));
-	}
 	if (m_shader.effect->has_parameter("Time", gs::effect_parameter::type::Float)) {
 		m_shader.effect->get_parameter("Time").set_float(m_timeExisting);
 	}
@@ -485,11 +907,48 @@ void gfx::effect_source::video_render(gs_effect_t* parent_effect) {
 		m_shader.effect->get_parameter("TimeActive").set_float(m_timeActive);
 	}
 
+	auto set_view_size = [this](uint32_t width, uint32_t height) {
+		if (m_shader.effect->has_parameter("ViewSize", gs::effect_parameter::type::Float2)) {
+			m_shader.effect->get_parameter("ViewSize").set_float2(float_t(width), float_t(height));
+		}
+		if (m_shader.effect->has_parameter("ViewSizeI"/*, gs::effect_parameter::type::Integer2*/)) {
+			m_shader.effect->get_parameter("ViewSizeI").set_int2(int32_t(width), int32_t(height));
+		}
+	};
+
 	gs_load_indexbuffer(nullptr);
 	gs_load_vertexbuffer(m_quadBuffer->update());
 
-	gs_reset_blend_state();
 	gs_enable_depth_test(false);
+	for (pass& ps : m_passes) {
+		uint32_t passW = max(uint32_t(viewW * ps.scale), 1u),
+			passH = max(uint32_t(viewH * ps.scale), 1u);
+
+		bind_pass_inputs(ps.inputs);
+		set_view_size(passW, passH);
+
+		try {
+			auto op = m_passTargets[ps.target]->render(passW, passH);
+			vec4 black; vec4_zero(&black);
+			gs_ortho(0, (float_t)passW, 0, (float_t)passH, 0, 1);
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+			gs_reset_blend_state();
+			gs_enable_blending(false);
+			gs_matrix_push();
+			gs_matrix_scale3f(float_t(passW), float_t(passH), 1);
+			while (gs_effect_loop(m_shader.effect->get_object(), ps.name.c_str())) {
+				gs_draw(gs_draw_mode::GS_TRISTRIP, 0, 4);
+			}
+			gs_matrix_pop();
+		} catch (std::exception& ex) {
+			P_LOG_ERROR("<gfx::effect_source> Rendering technique '%s' failed: %s", ps.name.c_str(), ex.what());
+		}
+	}
+	bind_pass_inputs(m_drawInputs);
+	set_view_size(viewW, viewH);
+
+	gs_reset_blend_state();
 	gs_matrix_push();
 	gs_matrix_scale3f(viewW, viewH, 1);
 	while (gs_effect_loop(m_shader.effect->get_object(), "Draw")) {
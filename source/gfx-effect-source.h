@@ -24,6 +24,7 @@
 #include "gs-texture.h"
 #include "gs-vertexbuffer.h"
 #include "gfx-source-texture.h"
+#include "gfx-texture-cache.h"
 #include <vector>
 #include <map>
 #include <utility>
@@ -32,6 +33,7 @@
 #define D_TYPE			"CustomShader.Type"
 #define D_INPUT_TEXT		"CustomShader.Input.Text"
 #define D_INPUT_FILE		"CustomShader.Input.File"
+#define D_INPUT_SCALE		"CustomShader.Input.Scale"
 
 // Translation Defines
 #define T_TYPE			"CustomShader.Type"
@@ -39,6 +41,11 @@
 #define T_TYPE_FILE		"CustomShader.Type.File"
 #define T_INPUT_TEXT		"CustomShader.Input.Text"
 #define T_INPUT_FILE		"CustomShader.Input.File"
+#define T_INPUT_SCALE		"CustomShader.Input.Scale"
+#define T_TEXTURE_TYPE_FILE	"CustomShader.Texture.Type.File"
+#define T_TEXTURE_TYPE_SOURCE	"CustomShader.Texture.Type.Source"
+#define T_TEXTURE_RESAMPLE	"CustomShader.Texture.Resample"
+#define T_TEXTURE_RESAMPLE_SIZE	"CustomShader.Texture.Resample.Size"
 
 namespace gfx {
 	class effect_source {
@@ -67,7 +74,8 @@ namespace gfx {
 
 			struct {
 				std::string path = "";
-				std::shared_ptr<gs::texture> tex;
+				std::shared_ptr<gfx::texture_cache::entry> image;
+				std::shared_ptr<gfx::texture_cache::entry> pending;
 				struct {
 					float_t time_updated = 0;
 					time_t time_create = 0;
@@ -85,12 +93,17 @@ namespace gfx {
 				bool doResample = false;
 				std::pair<uint32_t, uint32_t> resolution = { 10, 10 };
 				std::shared_ptr<gs::rendertarget> rt;
+
+				// What rt currently holds, files only change when replaced.
+				std::weak_ptr<gs::texture> input;
+				std::pair<uint32_t, uint32_t> size = { 0, 0 };
 			} resample;
 		};
 		struct matrix_parameter : parameter {
 
 		};
 		typedef std::pair<std::string, gs::effect_parameter::type> paramident_t;
+		typedef std::map<std::string, std::map<std::string, std::string>> annotations_t;
 
 		private:
 
@@ -102,6 +115,7 @@ namespace gfx {
 		// Effect Information
 		struct {
 			std::shared_ptr<gs::effect> effect;
+			uint64_t hash;
 			std::string text;
 			std::string path;
 			struct {
@@ -114,14 +128,37 @@ namespace gfx {
 		} m_shader;
 		std::map<paramident_t, std::shared_ptr<parameter>> m_parameters;
 
+		// Intermediate passes (techniques Pass0..PassN), run in order before 'Draw'.
+		struct pass {
+			std::string name;
+			float_t scale = 1.0f;
+			gs_color_format format = GS_RGBA;
+			std::vector<size_t> inputs;
+			size_t target = 0;
+		};
+		std::vector<pass> m_passes;
+		std::vector<size_t> m_drawInputs;
+		std::vector<std::shared_ptr<gs::rendertarget>> m_passTargets;
+
+		// Fraction of the view size the input is captured at.
+		float_t m_inputScale;
+
 		// Status
 		float_t m_timeExisting;
 		float_t m_timeActive;
 
 		std::string m_defaultShaderPath = "shaders/";
 
+		bool compile_effect(const char* code, size_t size, std::string name);
+		void build_passes(annotations_t& annotations);
+		void bind_pass_inputs(std::vector<size_t>& inputs);
+		bool is_pass_parameter(std::string name, gs::effect_parameter::type type);
+
 		static bool property_type_modified(void* priv, obs_properties_t* props, obs_property_t* prop, obs_data_t* sett);
 		static bool property_input_modified(void* priv, obs_properties_t* props, obs_property_t* prop, obs_data_t* sett);
+		static bool property_texture_type_modified(void* priv, obs_properties_t* props, obs_property_t* prop, obs_data_t* sett);
+
+		void check_textures(float_t time);
 		
 		virtual bool is_special_parameter(std::string name, gs::effect_parameter::type type) = 0;
 
@@ -155,5 +192,9 @@ namespace gfx {
 			Text,
 			File
 		};
+		enum class TextureTypes {
+			File,
+			Source
+		};
 	};
 }
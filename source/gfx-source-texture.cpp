@@ -16,6 +16,56 @@
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
 
 #include "gfx-source-texture.h"
+#include "plugin.h"
+#include <atomic>
+#include <map>
+#include <tuple>
+
+// Render targets shared by all source_textures, keyed by source and size. As
+// rendering only happens with the graphics context entered, the graphics lock
+// also protects these. Frame times can be zero, so never rendered targets and
+// the very first frame use a value no frame time has.
+#define FRAME_NEVER UINT64_MAX
+
+// Targets unused for this long (in nanoseconds) are dropped. Users that skip
+// frames or are hidden for a moment keep theirs instead of reallocating it.
+#define SHARED_TARGET_IDLE_TIME 1000000000ull
+struct shared_target {
+	std::shared_ptr<gs::rendertarget> rt;
+	uint64_t frame = FRAME_NEVER;
+};
+static std::map<std::tuple<obs_source_t*, uint32_t, uint32_t, uint32_t, uint32_t>, shared_target> shared_targets;
+static uint64_t shared_frame = FRAME_NEVER;
+static std::atomic<uint64_t> renders_saved(0);
+
+// A destroyed source's address may be reused by a new one, which must not
+// pick up the old renders.
+static void on_source_destroy(void*, calldata_t* data) {
+	obs_source_t* source = reinterpret_cast<obs_source_t*>(calldata_ptr(data, "source"));
+	obs_enter_graphics();
+	for (auto iter = shared_targets.begin(); iter != shared_targets.end();) {
+		if (std::get<0>(iter->first) == source) {
+			iter = shared_targets.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	obs_leave_graphics();
+}
+
+INITIALIZER(SourceTextureInit) {
+	initializerFunctions.push_back([] {
+		signal_handler_connect(obs_get_signal_handler(), "source_destroy", on_source_destroy, nullptr);
+	});
+	finalizerFunctions.push_back([] {
+		signal_handler_disconnect(obs_get_signal_handler(), "source_destroy", on_source_destroy, nullptr);
+		P_LOG_INFO("<gfx::source_texture> Saved %llu source renders by sharing them.",
+			(unsigned long long)renders_saved.load());
+		obs_enter_graphics();
+		shared_targets.clear();
+		obs_leave_graphics();
+	});
+}
 
 gfx::source_texture::~source_texture() {
 	obs_source_remove_active_child(m_parent, m_source);
@@ -23,11 +73,9 @@ gfx::source_texture::~source_texture() {
 		obs_source_release(m_source);
 		m_source = nullptr;
 	}
-	m_rt = nullptr;
 }
 
 gfx::source_texture::source_texture(obs_source_t* parent) {
-	m_rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
 	m_parent = parent;
 }
 
@@ -62,6 +110,10 @@ gfx::source_texture::source_texture(obs_source_t* src, obs_source_t* parent) : s
 }
 
 std::shared_ptr<gs::texture> gfx::source_texture::render(size_t width, size_t height) {
+	return render(0, 0, width, height);
+}
+
+std::shared_ptr<gs::texture> gfx::source_texture::render(size_t x, size_t y, size_t width, size_t height) {
 	if (!m_source) {
 		throw std::invalid_argument("Missing source to render.");
 	}
@@ -72,15 +124,42 @@ std::shared_ptr<gs::texture> gfx::source_texture::render(size_t width, size_t he
 		throw std::runtime_error("Height too large or too small.");
 	}
 
-	{
-		auto op = m_rt->render((uint32_t)width, (uint32_t)height);
+	// On a new frame, drop whatever has not been used for a while.
+	uint64_t frame = obs_get_video_frame_time();
+	if (frame != shared_frame) {
+		for (auto iter = shared_targets.begin(); iter != shared_targets.end();) {
+			uint64_t used = iter->second.frame;
+			if ((used == FRAME_NEVER) || ((frame > used) && ((frame - used) > SHARED_TARGET_IDLE_TIME))) {
+				iter = shared_targets.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+		shared_frame = frame;
+	}
+
+	shared_target& target = shared_targets[std::make_tuple(m_source,
+		(uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height)];
+	if (!target.rt) {
+		target.rt = std::make_shared<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	}
+
+	if (target.frame != frame) {
+		target.frame = frame;
+		auto op = target.rt->render((uint32_t)width, (uint32_t)height);
 		vec4 black; vec4_zero(&black);
-		gs_ortho(0, (float_t)width, 0, (float_t)height, 0, 1);
+		gs_ortho((float_t)x, (float_t)(x + width), (float_t)y, (float_t)(y + height), 0, 1);
 		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
 		obs_source_video_render(m_source);
+	} else {
+		renders_saved++;
 	}
 
 	std::shared_ptr<gs::texture> tex;
-	m_rt->get_texture(tex);
+	target.rt->get_texture(tex);
 	return tex;
 }
+
+uint64_t gfx::source_texture::get_renders_saved() {
+	return renders_saved.load();
+}
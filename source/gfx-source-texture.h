@@ -26,7 +26,6 @@ namespace gfx {
 	class source_texture {
 		obs_source_t* m_source;
 		obs_source_t* m_parent;
-		std::shared_ptr<gs::rendertarget> m_rt;
 
 		source_texture(obs_source_t* parent);
 		public:
@@ -38,6 +37,24 @@ namespace gfx {
 		obs_source_t* get_object();
 		obs_source_t* get_parent();
 
+		/*!
+		 * \brief Render the source and return the result
+		 *
+		 * The result is shared with every other source_texture that renders
+		 * the same source at the same size, and only valid until the next
+		 * video frame. The source itself is rendered at most once per frame.
+		 */
 		std::shared_ptr<gs::texture> render(size_t width, size_t height);
+
+		/*!
+		 * \brief Render only a region of the source and return the result
+		 *
+		 * The projection is moved onto the region, so the result has the size
+		 * of the region and nothing outside of it is kept.
+		 */
+		std::shared_ptr<gs::texture> render(size_t x, size_t y, size_t width, size_t height);
+
+		// Number of renders skipped so far because the result was shared.
+		static uint64_t get_renders_saved();
 	};
 }
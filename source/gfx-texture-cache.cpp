@@ -0,0 +1,130 @@
+// Modern effects for a modern Streamer
+// Copyright (C) 2017 Michael Fabian Dirks
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+
+#include "gfx-texture-cache.h"
+#include "plugin.h"
+#include "util-threadpool.h"
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+
+// Decoded images, keyed by path and modification time. A modified file gets
+// a new entry, while users of the old one keep it until they reload.
+static std::mutex cache_lock;
+static std::map<std::pair<std::string, time_t>, std::weak_ptr<gfx::texture_cache::entry>> cache;
+static util::threadpool* decode_pool;
+
+INITIALIZER(TextureCacheInit) {
+	initializerFunctions.push_back([] {
+		decode_pool = new util::threadpool();
+	});
+	finalizerFunctions.push_back([] {
+		delete decode_pool;
+		decode_pool = nullptr;
+	});
+}
+
+gfx::texture_cache::entry::entry(std::string path) : m_path(path), m_decoded(false) {
+	memset(&m_image, 0, sizeof(gs_image_file_t));
+}
+
+gfx::texture_cache::entry::~entry() {
+	m_texture = nullptr;
+	obs_enter_graphics();
+	gs_image_file_free(&m_image);
+	obs_leave_graphics();
+}
+
+void gfx::texture_cache::entry::decode() {
+	gs_image_file_init(&m_image, m_path.c_str());
+	if (!m_image.loaded) {
+		P_LOG_ERROR("<gfx::texture_cache> Decoding image '%s' failed.", m_path.c_str());
+	}
+	m_decoded.store(true, std::memory_order_release);
+}
+
+std::string gfx::texture_cache::entry::get_path() {
+	return m_path;
+}
+
+bool gfx::texture_cache::entry::is_decoded() {
+	return m_decoded.load(std::memory_order_acquire);
+}
+
+bool gfx::texture_cache::entry::has_failed() {
+	// The image is only written before m_decoded is set.
+	return is_decoded() && !m_image.loaded;
+}
+
+std::shared_ptr<gs::texture> gfx::texture_cache::entry::get_texture() {
+	if (m_texture || !is_decoded() || !m_image.loaded) {
+		return m_texture;
+	}
+
+	gs_image_file_init_texture(&m_image);
+	if (m_image.texture) {
+		m_texture = std::make_shared<gs::texture>(m_image.texture, false);
+	}
+	return m_texture;
+}
+
+std::shared_ptr<gfx::texture_cache::entry> gfx::texture_cache::load(std::string path) {
+	struct stat stats;
+	if (os_stat(path.c_str(), &stats) != 0) {
+		return nullptr;
+	}
+
+	auto key = std::make_pair(path, stats.st_mtime);
+	std::shared_ptr<entry> image;
+	{
+		std::unique_lock<std::mutex> ulock(cache_lock);
+		auto kv = cache.find(key);
+		if (kv != cache.end()) {
+			image = kv->second.lock();
+			if (image) {
+				return image;
+			}
+		}
+
+		image = std::make_shared<entry>(path);
+		cache.insert_or_assign(key, image);
+
+		// Drop entries that no longer have any users.
+		for (auto iter = cache.begin(); iter != cache.end();) {
+			if (iter->second.expired()) {
+				iter = cache.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	}
+
+	if (decode_pool) {
+		std::weak_ptr<entry> weak = image;
+		decode_pool->push([weak] {
+			auto image = weak.lock();
+			if (image) {
+				image->decode();
+			}
+		});
+	} else {
+		image->decode();
+	}
+	return image;
+}
@@ -0,0 +1,78 @@
+// Modern effects for a modern Streamer
+// Copyright (C) 2017 Michael Fabian Dirks
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "gs-texture.h"
+extern "C" {
+#pragma warning( push )
+#pragma warning( disable: 4201 )
+#include <graphics/image-file.h>
+#pragma warning( pop )
+}
+
+namespace gfx {
+	/*!
+	 * \brief Process-wide cache of image files used as textures
+	 *
+	 * Images are decoded on a pool of worker threads and shared by everyone
+	 * asking for the same file, as long as it was not modified in between.
+	 * Only the final upload to the GPU happens on the graphics thread.
+	 */
+	class texture_cache {
+		public:
+		class entry {
+			friend class texture_cache;
+
+			std::string m_path;
+			gs_image_file_t m_image;
+			std::atomic<bool> m_decoded;
+			std::shared_ptr<gs::texture> m_texture;
+
+			void decode();
+
+			public:
+			entry(std::string path);
+			~entry();
+
+			std::string get_path();
+
+			// True once decoding finished, successfully or not.
+			bool is_decoded();
+
+			// True once decoding finished without a usable image.
+			bool has_failed();
+
+			// Must be called with the graphics context entered. Returns
+			// nullptr while the image is still being decoded or failed to.
+			std::shared_ptr<gs::texture> get_texture();
+		};
+
+		/*!
+		 * \brief Get the cached image for a file, queueing it for decoding if needed
+		 *
+		 * Safe to call from any thread, never blocks on disk I/O beyond
+		 * querying the file modification time.
+		 *
+		 * \param path Path to the image file.
+		 */
+		static std::shared_ptr<entry> load(std::string path);
+	};
+}
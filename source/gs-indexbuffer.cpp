@@ -19,6 +19,8 @@
 
 #include "gs-indexbuffer.h"
 #include "gs-limits.h"
+#include <algorithm>
+#include <cstring>
 extern "C" {
 	#pragma warning( push )
 	#pragma warning( disable: 4201 )
@@ -29,19 +31,21 @@ extern "C" {
 gs::index_buffer::index_buffer(uint32_t maximumVertices) {
 	this->reserve(maximumVertices);
 
+	// libobs takes ownership of the memory it is given, so it gets its own.
 	obs_enter_graphics();
-	m_indexBuffer = gs_indexbuffer_create(gs_index_type::GS_UNSIGNED_LONG, this->data(), maximumVertices, GS_DYNAMIC);
+	m_indexBuffer = gs_indexbuffer_create(gs_index_type::GS_UNSIGNED_LONG,
+		bzalloc(sizeof(uint32_t) * maximumVertices), maximumVertices, GS_DYNAMIC);
 	obs_leave_graphics();
 }
 
 gs::index_buffer::index_buffer() : index_buffer(MAXIMUM_VERTICES) {}
 
 gs::index_buffer::index_buffer(index_buffer& other) : index_buffer((uint32_t)other.size()) {
-	std::copy(other.begin(), other.end(), this->end());
+	this->insert(this->end(), other.begin(), other.end());
 }
 
 gs::index_buffer::index_buffer(std::vector<uint32_t>& other) : index_buffer((uint32_t)other.size()) {
-	std::copy(other.begin(), other.end(), this->end());
+	this->insert(this->end(), other.begin(), other.end());
 }
 
 gs::index_buffer::~index_buffer() {
@@ -57,6 +61,8 @@ gs_indexbuffer_t* gs::index_buffer::get() {
 gs_indexbuffer_t* gs::index_buffer::get(bool refreshGPU) {
 	if (refreshGPU) {
 		obs_enter_graphics();
+		size_t count = std::min(this->size(), gs_indexbuffer_get_num_indices(m_indexBuffer));
+		std::memcpy(gs_indexbuffer_get_data(m_indexBuffer), this->data(), sizeof(uint32_t) * count);
 		gs_indexbuffer_flush(m_indexBuffer);
 		obs_leave_graphics();
 	}
@@ -300,11 +300,11 @@ gs_vertbuffer_t* gs::vertex_buffer::update(bool refreshGPU) {
 	if (m_size > m_capacity)
 		throw std::out_of_range("size is larger than capacity");
 
-	// Update VertexBuffer data.
+	// Update VertexBuffer data, only the used vertices are uploaded.
 	obs_enter_graphics();
 	m_vertexbufferdata = gs_vertexbuffer_get_data(m_vertexbuffer);
 	std::memset(m_vertexbufferdata, 0, sizeof(gs_vb_data));
-	m_vertexbufferdata->num = m_capacity;
+	m_vertexbufferdata->num = m_size;
 	m_vertexbufferdata->points = m_positions;
 	m_vertexbufferdata->normals = m_normals;
 	m_vertexbufferdata->tangents = m_tangents;
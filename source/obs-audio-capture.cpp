@@ -18,27 +18,102 @@
  */
 
 #include "obs-audio-capture.h"
+#include <map>
 
-void obs::audio_capture::audio_capture_cb(void* data, obs_source_t*, const struct audio_data* audio, bool muted) {
-	auto self = reinterpret_cast<obs::audio_capture*>(data);
-	self->cb(self->cb_data, audio, muted);
-}
+// Hubs by source, kept alive only by their subscribers.
+static std::mutex hubs_lock;
+static std::map<obs_source_t*, std::weak_ptr<obs::audio_capture_hub>> hubs;
 
-obs::audio_capture::audio_capture(obs_source_t* source) {
+obs::audio_capture::audio_capture(obs_source_t* source) : next(nullptr) {
 	this->source = source;
-	obs_source_add_audio_capture_callback(this->source, audio_capture_cb, this);
+	this->cb_data = nullptr;
+	this->subscribed = false;
+	this->hub = audio_capture_hub::get(source);
 }
 
 obs::audio_capture::~audio_capture() {
-	obs_source_remove_audio_capture_callback(this->source, audio_capture_cb, this);
+	if (this->subscribed) {
+		this->hub->unsubscribe(this);
+	}
 }
 
 void obs::audio_capture::set_callback(audio_capture_callback_t cb, void* data) {
+	// Never change the callback while the audio thread may be calling it.
+	if (this->subscribed) {
+		this->hub->unsubscribe(this);
+	}
 	this->cb = cb;
 	this->cb_data = data;
+	this->subscribed = (this->cb != nullptr);
+	if (this->subscribed) {
+		this->hub->subscribe(this);
+	}
 }
 
 void obs::audio_capture::set_callback(audio_capture_callback_t cb) {
-	this->cb = cb;
-	this->cb_data = nullptr;
+	set_callback(cb, nullptr);
+}
+
+void obs::audio_capture_hub::audio_capture_cb(void* data, obs_source_t*, const struct audio_data* audio, bool muted) {
+	auto self = reinterpret_cast<obs::audio_capture_hub*>(data);
+
+	uint32_t slot = self->m_epoch.enter();
+	for (audio_capture* sub = self->m_head.load(); sub != nullptr; sub = sub->next.load()) {
+		sub->cb(sub->cb_data, audio, muted);
+	}
+	self->m_epoch.leave(slot);
+}
+
+obs::audio_capture_hub::audio_capture_hub(obs_source_t* source) : m_source(source), m_head(nullptr) {
+	obs_source_add_audio_capture_callback(m_source, audio_capture_cb, this);
+}
+
+obs::audio_capture_hub::~audio_capture_hub() {
+	obs_source_remove_audio_capture_callback(m_source, audio_capture_cb, this);
+}
+
+void obs::audio_capture_hub::subscribe(audio_capture* subscriber) {
+	std::unique_lock<std::mutex> ulock(m_lock);
+	subscriber->next.store(m_head.load());
+	m_head.store(subscriber);
+}
+
+void obs::audio_capture_hub::unsubscribe(audio_capture* subscriber) {
+	std::unique_lock<std::mutex> ulock(m_lock);
+	if (m_head.load() == subscriber) {
+		m_head.store(subscriber->next.load());
+	} else {
+		for (audio_capture* sub = m_head.load(); sub != nullptr; sub = sub->next.load()) {
+			if (sub->next.load() == subscriber) {
+				sub->next.store(subscriber->next.load());
+				break;
+			}
+		}
+	}
+	m_epoch.synchronize();
+	subscriber->next.store(nullptr);
+}
+
+std::shared_ptr<obs::audio_capture_hub> obs::audio_capture_hub::get(obs_source_t* source) {
+	std::unique_lock<std::mutex> ulock(hubs_lock);
+	std::shared_ptr<audio_capture_hub> hub;
+
+	auto kv = hubs.find(source);
+	if (kv != hubs.end()) {
+		hub = kv->second.lock();
+	}
+	if (!hub) {
+		hub = std::make_shared<audio_capture_hub>(source);
+		hubs.insert_or_assign(source, hub);
+	}
+
+	// Drop entries that no longer have any users.
+	for (auto iter = hubs.begin(); iter != hubs.end();) {
+		if (iter->second.expired()) {
+			iter = hubs.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+	return hub;
 }
@@ -19,23 +19,64 @@
 
 #pragma once
 #include <obs.h>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include "util-epoch.h"
 
 namespace obs {
 	typedef std::function<void(void* data, struct audio_data const *audio, bool muted)> audio_capture_callback_t;
 
+	class audio_capture_hub;
+
 	class audio_capture {
+		friend class audio_capture_hub;
+
 		obs_source_t* source;
 		audio_capture_callback_t cb;
 		void* cb_data;
 
-		static void audio_capture_cb(void*, obs_source_t*, struct audio_data const *, bool);
+		std::shared_ptr<audio_capture_hub> hub;
+		std::atomic<audio_capture*> next;
+		bool subscribed;
 
 		public:
 		audio_capture(obs_source_t* source);
 		virtual ~audio_capture();
 
+		// Capture starts with the first callback being set.
 		void set_callback(audio_capture_callback_t cb, void* data);
 		void set_callback(audio_capture_callback_t cb);
 	};
+
+	/*!
+	 * \brief Single audio capture callback for a source, fanned out to every audio_capture of it
+	 *
+	 * Subscribers form an intrusive list which the audio thread walks without
+	 * locking. Unsubscribing unlinks the subscriber and then waits until every
+	 * delivery that could still see it is done (epoch based reclamation), so it
+	 * must never be called from inside a callback of the same source.
+	 */
+	class audio_capture_hub {
+		obs_source_t* m_source;
+		std::atomic<audio_capture*> m_head;
+		std::mutex m_lock;
+		util::epoch m_epoch;
+
+		static void audio_capture_cb(void*, obs_source_t*, struct audio_data const *, bool);
+
+		public:
+		audio_capture_hub(obs_source_t* source);
+		virtual ~audio_capture_hub();
+
+		audio_capture_hub(const audio_capture_hub&) = delete;
+		audio_capture_hub& operator=(const audio_capture_hub&) = delete;
+
+		void subscribe(audio_capture* subscriber);
+		void unsubscribe(audio_capture* subscriber);
+
+		// Get the hub for a source, creating it if there is none yet.
+		static std::shared_ptr<audio_capture_hub> get(obs_source_t* source);
+	};
 }
@@ -0,0 +1,245 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "obs-audio-forwarder.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+#include "plugin.h"
+extern "C" {
+#pragma warning( push )
+#pragma warning( disable: 4201 )
+#include <media-io/audio-io.h>
+#include <util/platform.h>
+#pragma warning( pop )
+}
+
+// Packets held back by each jitter buffer at most, about 5 seconds of audio.
+#define JITTER_BUFFER_SIZE 256
+
+// Packets owned by each forwarder, enough to fill the jitter buffer and still
+// have some waiting for the worker.
+#define PACKET_POOL_SIZE (JITTER_BUFFER_SIZE + 32)
+
+// Timestamps are only this exact (in nanoseconds). Covers capture jitter and
+// the rounding of the computed end of a packet.
+#define TIMESTAMP_TOLERANCE 1000000ull
+
+// All forwarders, serviced by a single worker thread. The worker copies the
+// list and works on the copy inside worker_epoch, so a forwarder that was
+// removed from the list is safe to destroy once the epoch is synchronized.
+static std::mutex forwarders_lock;
+static std::list<obs::audio_forwarder*> forwarders;
+static util::epoch worker_epoch;
+static std::condition_variable worker_notify;
+static std::thread worker;
+static bool worker_stop = false;
+
+INITIALIZER(AudioForwarderInit) {
+	finalizerFunctions.push_back([] {
+		{
+			std::unique_lock<std::mutex> ulock(forwarders_lock);
+			worker_stop = true;
+		}
+		worker_notify.notify_all();
+		if (worker.joinable())
+			worker.join();
+	});
+}
+
+void obs::audio_packet::assign(const struct audio_data* capture) {
+	audio_output_info const* aoi = audio_output_get_info(obs_get_audio());
+
+	for (size_t plane = 0; plane < MAX_AV_PLANES; plane++) {
+		if (!capture->data[plane]) {
+			audio.data[plane] = nullptr;
+			continue;
+		}
+
+		if (data[plane].size() < capture->frames) {
+			data[plane].resize(capture->frames);
+		}
+		memcpy(data[plane].data(), capture->data[plane], capture->frames * sizeof(float_t));
+		audio.data[plane] = (uint8_t*)data[plane].data();
+	}
+	audio.format = aoi->format;
+	audio.frames = capture->frames;
+	audio.timestamp = capture->timestamp;
+	audio.samples_per_sec = aoi->samples_per_sec;
+	audio.speakers = aoi->speakers;
+}
+
+void obs::audio_forwarder::work() {
+	// Outputting audio may take locks inside libobs, so it happens without
+	// holding forwarders_lock.
+	std::vector<audio_forwarder*> active;
+	std::unique_lock<std::mutex> ulock(forwarders_lock);
+	while (!worker_stop) {
+		active.assign(forwarders.begin(), forwarders.end());
+		uint32_t slot = worker_epoch.enter();
+		ulock.unlock();
+
+		uint64_t now = os_gettime_ns();
+		for (audio_forwarder* fwd : active) {
+			fwd->process(now);
+		}
+		worker_epoch.leave(slot);
+
+		// Pushing notifies without taking the lock, so a wakeup can be
+		// missed. Waking up every few milliseconds bounds the delay.
+		ulock.lock();
+		worker_notify.wait_for(ulock, std::chrono::milliseconds(5));
+	}
+}
+
+void obs::audio_forwarder::process(uint64_t now) {
+	// Move new packets into the jitter buffer, ordered by timestamp.
+	audio_packet** slot;
+	while ((slot = m_queue.front()) != nullptr) {
+		audio_packet* packet = *slot;
+		m_queue.pop();
+
+		if ((packet->audio.timestamp + TIMESTAMP_TOLERANCE) < m_nextTimestamp) {
+			// Anything before this was already sent out.
+			m_drops++;
+			release(packet);
+			continue;
+		}
+
+		audio_packet** first = m_buffer.data();
+		audio_packet** last = first + m_bufferSize;
+		audio_packet** pos = std::upper_bound(first, last, packet,
+			[](const audio_packet* a, const audio_packet* b) {
+			return a->audio.timestamp < b->audio.timestamp;
+		});
+		std::copy_backward(pos, last, last + 1);
+		*pos = packet;
+		m_bufferSize++;
+
+		// There is room for one more than the limit, so the oldest can be
+		// dropped after inserting.
+		if (m_bufferSize > JITTER_BUFFER_SIZE) {
+			release(first[0]);
+			std::copy(first + 1, first + m_bufferSize, first);
+			m_bufferSize--;
+			m_overruns++;
+		}
+	}
+
+	// Send out everything that is due.
+	uint64_t delay = m_delay.load();
+	size_t sent = 0;
+	for (; sent < m_bufferSize; sent++) {
+		audio_packet* packet = m_buffer[sent];
+		if ((packet->audio.timestamp + delay) > now)
+			break;
+
+		// Packets start a bit after where the previous one ended when something was missing.
+		if ((m_nextTimestamp != 0) && (packet->audio.timestamp > (m_nextTimestamp + TIMESTAMP_TOLERANCE))) {
+			m_underruns++;
+		}
+		m_nextTimestamp = packet->audio.timestamp
+			+ (uint64_t(packet->audio.frames) * 1000000000ull / max(packet->audio.samples_per_sec, 1u));
+
+		obs_source_audio audio = packet->audio;
+		audio.timestamp += delay;
+		obs_source_output_audio(m_source, &audio);
+		release(packet);
+	}
+	if (sent > 0) {
+		std::copy(m_buffer.begin() + sent, m_buffer.begin() + m_bufferSize, m_buffer.begin());
+		m_bufferSize -= sent;
+	}
+}
+
+void obs::audio_forwarder::release(audio_packet* packet) {
+	// The free ring holds every packet, so there always is a slot.
+	*m_free.acquire() = packet;
+	m_free.commit();
+}
+
+obs::audio_forwarder::audio_forwarder(obs_source_t* target) : m_source(target), m_free(PACKET_POOL_SIZE),
+	m_queue(PACKET_POOL_SIZE), m_drops(0),
+	m_bufferSize(0), m_delay(0), m_nextTimestamp(0), m_underruns(0), m_overruns(0) {
+	// Planes are sized for the audio output up front, so filling a packet
+	// never allocates.
+	size_t channels = get_audio_channels(audio_output_get_info(obs_get_audio())->speakers);
+	m_packets.resize(PACKET_POOL_SIZE);
+	for (std::unique_ptr<audio_packet>& packet : m_packets) {
+		packet = std::make_unique<audio_packet>();
+		memset(&packet->audio, 0, sizeof(obs_source_audio));
+		for (size_t plane = 0; plane < channels; plane++) {
+			packet->data[plane].resize(AUDIO_OUTPUT_FRAMES);
+		}
+		release(packet.get());
+	}
+	m_buffer.resize(JITTER_BUFFER_SIZE + 1);
+
+	std::unique_lock<std::mutex> ulock(forwarders_lock);
+	forwarders.push_back(this);
+	if (!worker.joinable()) {
+		worker_stop = false;
+		worker = std::thread(work);
+	}
+}
+
+obs::audio_forwarder::~audio_forwarder() {
+	// Wait for the worker to be done with this forwarder. Packets still in
+	// the rings are owned by m_packets and go away with it.
+	std::unique_lock<std::mutex> ulock(forwarders_lock);
+	forwarders.remove(this);
+	worker_epoch.synchronize();
+}
+
+obs::audio_packet* obs::audio_forwarder::allocate() {
+	audio_packet** slot = m_free.front();
+	if (!slot) {
+		m_drops++;
+		return nullptr;
+	}
+	audio_packet* packet = *slot;
+	m_free.pop();
+	return packet;
+}
+
+void obs::audio_forwarder::push(audio_packet* packet) {
+	// The queue holds every packet, so there always is a slot.
+	*m_queue.acquire() = packet;
+	m_queue.commit();
+	worker_notify.notify_one();
+}
+
+void obs::audio_forwarder::set_delay(uint64_t delay) {
+	m_delay.store(delay);
+}
+
+uint64_t obs::audio_forwarder::get_drops() {
+	return m_drops.load();
+}
+
+uint64_t obs::audio_forwarder::get_underruns() {
+	return m_underruns.load();
+}
+
+uint64_t obs::audio_forwarder::get_overruns() {
+	return m_overruns.load();
+}
@@ -0,0 +1,103 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <obs.h>
+#include "util-epoch.h"
+#include "util-ringbuffer.h"
+
+namespace obs {
+	/*!
+	 * \brief Captured audio, owned by the pool of an audio_forwarder
+	 *
+	 * Packets are filled in place and handed to the worker as they are, so a
+	 * capture is copied exactly once.
+	 */
+	struct audio_packet {
+		obs_source_audio audio;
+		std::vector<float_t> data[MAX_AV_PLANES];
+
+		// Fill the packet from a capture callback, format taken from the audio output.
+		void assign(const struct audio_data* capture);
+	};
+
+	/*!
+	 * \brief Forwards captured audio to sources from one shared worker thread
+	 *
+	 * Replaces one output thread per receiving source. Every forwarder owns a
+	 * fixed pool of packets which travel from the pushing thread to the worker
+	 * and back through two rings, so neither side allocates, locks or blocks.
+	 * Captures are dropped instead if every packet is in use.
+	 *
+	 * Packets pass through a jitter buffer which orders them by timestamp and
+	 * holds them back until the configured delay has passed, so the output
+	 * has a steady cadence and can be kept in sync with delayed video.
+	 */
+	class audio_forwarder {
+		obs_source_t* m_source;
+		std::vector<std::unique_ptr<audio_packet>> m_packets;
+		util::spsc_ring<audio_packet*> m_free;
+		util::spsc_ring<audio_packet*> m_queue;
+		std::atomic<uint64_t> m_drops;
+
+		// Jitter buffer, only touched by the worker thread. The first
+		// m_bufferSize packets are sorted by timestamp, the array is sized in
+		// the constructor and never grows.
+		std::vector<audio_packet*> m_buffer;
+		size_t m_bufferSize;
+		std::atomic<uint64_t> m_delay;
+		uint64_t m_nextTimestamp;
+		std::atomic<uint64_t> m_underruns;
+		std::atomic<uint64_t> m_overruns;
+
+		void process(uint64_t now);
+		void release(audio_packet* packet);
+
+		static void work();
+
+		public:
+		audio_forwarder(obs_source_t* target);
+		virtual ~audio_forwarder();
+
+		audio_forwarder(const audio_forwarder&) = delete;
+		audio_forwarder& operator=(const audio_forwarder&) = delete;
+
+		// Take an unused packet, or nullptr if all of them are in use. This and
+		// push() must only be called by a single thread at a time.
+		audio_packet* allocate();
+
+		// Queue a packet returned by allocate() for output.
+		void push(audio_packet* packet);
+
+		// Delay in nanoseconds applied to every packet's timestamp.
+		void set_delay(uint64_t delay);
+
+		// Captures dropped because no packet was free or they arrived too late.
+		uint64_t get_drops();
+
+		// Gaps in the output, because packets did not arrive in time.
+		uint64_t get_underruns();
+
+		// Packets dropped because the jitter buffer was full.
+		uint64_t get_overruns();
+	};
+}
@@ -19,6 +19,7 @@
 
 #include "source-mirror.h"
 #include "strings.h"
+#include "util-audio.h"
 #include <memory>
 #include <cstring>
 #include <vector>
@@ -30,6 +31,15 @@
 #define P_SOURCE					"Source.Mirror.Source"
 #define P_SOURCE_SIZE					"Source.Mirror.Source.Size"
 #define P_SOURCE_AUDIO					"Source.Mirror.Source.Audio"
+#define P_SOURCE_AUDIOONLY				"Source.Mirror.Source.AudioOnly"
+#define P_AUDIO_GAIN					"Source.Mirror.Audio.Gain"
+#define P_AUDIO_DOWNMIX					"Source.Mirror.Audio.Downmix"
+#define P_AUDIO_DELAY					"Source.Mirror.Audio.Delay"
+#define P_CROP						"Source.Mirror.Crop"
+#define P_CROP_LEFT					"Source.Mirror.Crop.Left"
+#define P_CROP_TOP					"Source.Mirror.Crop.Top"
+#define P_CROP_RIGHT					"Source.Mirror.Crop.Right"
+#define P_CROP_BOTTOM					"Source.Mirror.Crop.Bottom"
 #define P_SCALING					"Source.Mirror.Scaling"
 #define P_SCALING_METHOD				"Source.Mirror.Scaling.Method"
 #define P_SCALING_METHOD_POINT				"Source.Mirror.Scaling.Method.Point"
@@ -39,6 +49,27 @@
 #define P_SCALING_METHOD_LANCZOS			"Source.Mirror.Scaling.Method.Lanczos"
 #define P_SCALING_SIZE					"Source.Mirror.Scaling.Size"
 #define P_SCALING_TRANSFORMKEEPORIGINAL			"Source.Mirror.Scaling.TransformKeepOriginal"
+#define P_FRAMESKIP					"Source.Mirror.FrameSkip"
+
+#define AUDIO_MIX_INPUTS				3
+static const char* P_AUDIO_MIX_SOURCE[AUDIO_MIX_INPUTS] = {
+	"Source.Mirror.Audio.Mix.Source.1",
+	"Source.Mirror.Audio.Mix.Source.2",
+	"Source.Mirror.Audio.Mix.Source.3",
+};
+static const char* P_AUDIO_MIX_GAIN[AUDIO_MIX_INPUTS] = {
+	"Source.Mirror.Audio.Mix.Gain.1",
+	"Source.Mirror.Audio.Mix.Gain.2",
+	"Source.Mirror.Audio.Mix.Gain.3",
+};
+
+// Limits how far a mixed source can run ahead of the mirrored one. The queue
+// holds twice that, so the mixed source has room until the next trim.
+#define AUDIO_MIX_MAX_FRAMES				(AUDIO_OUTPUT_FRAMES * 4)
+#define AUDIO_MIX_QUEUE_FRAMES				(AUDIO_MIX_MAX_FRAMES * 2)
+
+// Spreads the scheduled frames of mirrors that skip frames.
+static std::atomic<uint32_t> mirror_counter(0);
 
 enum class ScalingMethod : int64_t {
 	Point,
@@ -91,9 +122,23 @@ const char * Source::MirrorAddon::get_name(void *) {
 void Source::MirrorAddon::get_defaults(obs_data_t *data) {
 	obs_data_set_default_string(data, P_SOURCE, "");
 	obs_data_set_default_bool(data, P_SOURCE_AUDIO, false);
+	obs_data_set_default_bool(data, P_SOURCE_AUDIOONLY, false);
+	obs_data_set_default_double(data, P_AUDIO_GAIN, 100.0);
+	obs_data_set_default_bool(data, P_AUDIO_DOWNMIX, false);
+	obs_data_set_default_int(data, P_AUDIO_DELAY, 0);
+	for (size_t idx = 0; idx < AUDIO_MIX_INPUTS; idx++) {
+		obs_data_set_default_string(data, P_AUDIO_MIX_SOURCE[idx], "");
+		obs_data_set_default_double(data, P_AUDIO_MIX_GAIN[idx], 100.0);
+	}
+	obs_data_set_default_bool(data, P_CROP, false);
+	obs_data_set_default_int(data, P_CROP_LEFT, 0);
+	obs_data_set_default_int(data, P_CROP_TOP, 0);
+	obs_data_set_default_int(data, P_CROP_RIGHT, 0);
+	obs_data_set_default_int(data, P_CROP_BOTTOM, 0);
 	obs_data_set_default_bool(data, P_SCALING, false);
 	obs_data_set_default_string(data, P_SCALING_SIZE, "100x100");
 	obs_data_set_default_int(data, P_SCALING_METHOD, (int64_t)ScalingMethod::Bilinear);
+	obs_data_set_default_int(data, P_FRAMESKIP, 1);
 }
 
 bool Source::MirrorAddon::modified_properties(obs_properties_t *pr, obs_property_t *p, obs_data_t *data) {
@@ -109,10 +154,34 @@ bool Source::MirrorAddon::modified_properties(obs_properties_t *pr, obs_property
 		}
 	}
 
-	if (obs_properties_get(pr, P_SCALING) == p) {
-		bool show = obs_data_get_bool(data, P_SCALING);
+	if (obs_properties_get(pr, P_SOURCE_AUDIO) == p) {
+		bool show = obs_data_get_bool(data, P_SOURCE_AUDIO);
+		obs_property_set_visible(obs_properties_get(pr, P_AUDIO_GAIN), show);
+		obs_property_set_visible(obs_properties_get(pr, P_AUDIO_DOWNMIX), show);
+		obs_property_set_visible(obs_properties_get(pr, P_AUDIO_DELAY), show);
+		for (size_t idx = 0; idx < AUDIO_MIX_INPUTS; idx++) {
+			obs_property_set_visible(obs_properties_get(pr, P_AUDIO_MIX_SOURCE[idx]), show);
+			obs_property_set_visible(obs_properties_get(pr, P_AUDIO_MIX_GAIN[idx]), show);
+		}
+		return true;
+	}
+
+	if ((obs_properties_get(pr, P_SCALING) == p) || (obs_properties_get(pr, P_CROP) == p)
+		|| (obs_properties_get(pr, P_SOURCE_AUDIOONLY) == p)) {
+		bool video = !obs_data_get_bool(data, P_SOURCE_AUDIOONLY);
+		bool crop = video && obs_data_get_bool(data, P_CROP);
+		obs_property_set_visible(obs_properties_get(pr, P_CROP), video);
+		obs_property_set_visible(obs_properties_get(pr, P_CROP_LEFT), crop);
+		obs_property_set_visible(obs_properties_get(pr, P_CROP_TOP), crop);
+		obs_property_set_visible(obs_properties_get(pr, P_CROP_RIGHT), crop);
+		obs_property_set_visible(obs_properties_get(pr, P_CROP_BOTTOM), crop);
+
+		bool show = video && obs_data_get_bool(data, P_SCALING);
+		obs_property_set_visible(obs_properties_get(pr, P_SCALING), video);
+		obs_property_set_visible(obs_properties_get(pr, P_FRAMESKIP), video);
 		obs_property_set_visible(obs_properties_get(pr, P_SCALING_METHOD), show);
 		obs_property_set_visible(obs_properties_get(pr, P_SCALING_SIZE), show);
+		obs_property_set_visible(obs_properties_get(pr, P_SCALING_TRANSFORMKEEPORIGINAL), show);
 		return true;
 	}
 
@@ -146,6 +215,37 @@ obs_properties_t * Source::MirrorAddon::get_properties(void *) {
 
 	p = obs_properties_add_bool(pr, P_SOURCE_AUDIO, P_TRANSLATE(P_SOURCE_AUDIO));
 	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SOURCE_AUDIO)));
+	obs_property_set_modified_callback(p, modified_properties);
+
+	p = obs_properties_add_bool(pr, P_SOURCE_AUDIOONLY, P_TRANSLATE(P_SOURCE_AUDIOONLY));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SOURCE_AUDIOONLY)));
+	obs_property_set_modified_callback(p, modified_properties);
+
+	p = obs_properties_add_float_slider(pr, P_AUDIO_GAIN, P_TRANSLATE(P_AUDIO_GAIN), 0.0, 200.0, 0.1);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_AUDIO_GAIN)));
+
+	p = obs_properties_add_bool(pr, P_AUDIO_DOWNMIX, P_TRANSLATE(P_AUDIO_DOWNMIX));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_AUDIO_DOWNMIX)));
+
+	p = obs_properties_add_int(pr, P_AUDIO_DELAY, P_TRANSLATE(P_AUDIO_DELAY), 0, 5000, 1);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_AUDIO_DELAY)));
+
+	for (size_t idx = 0; idx < AUDIO_MIX_INPUTS; idx++) {
+		p = obs_properties_add_list(pr, P_AUDIO_MIX_SOURCE[idx], P_TRANSLATE(P_AUDIO_MIX_SOURCE[idx]),
+			OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(p, "", "");
+		obs_enum_sources(UpdateSourceListCB, p);
+
+		p = obs_properties_add_float_slider(pr, P_AUDIO_MIX_GAIN[idx], P_TRANSLATE(P_AUDIO_MIX_GAIN[idx]), 0.0, 200.0, 0.1);
+	}
+
+	p = obs_properties_add_bool(pr, P_CROP, P_TRANSLATE(P_CROP));
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_CROP)));
+	obs_property_set_modified_callback(p, modified_properties);
+	p = obs_properties_add_int(pr, P_CROP_LEFT, P_TRANSLATE(P_CROP_LEFT), 0, 16384, 1);
+	p = obs_properties_add_int(pr, P_CROP_TOP, P_TRANSLATE(P_CROP_TOP), 0, 16384, 1);
+	p = obs_properties_add_int(pr, P_CROP_RIGHT, P_TRANSLATE(P_CROP_RIGHT), 0, 16384, 1);
+	p = obs_properties_add_int(pr, P_CROP_BOTTOM, P_TRANSLATE(P_CROP_BOTTOM), 0, 16384, 1);
 
 	p = obs_properties_add_bool(pr, P_SCALING, P_TRANSLATE(P_SCALING));
 	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SCALING)));
@@ -167,6 +267,9 @@ obs_properties_t * Source::MirrorAddon::get_properties(void *) {
 	p = obs_properties_add_bool(pr, P_SCALING_TRANSFORMKEEPORIGINAL, P_TRANSLATE(P_SCALING_TRANSFORMKEEPORIGINAL));
 	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_SCALING_TRANSFORMKEEPORIGINAL)));
 
+	p = obs_properties_add_int_slider(pr, P_FRAMESKIP, P_TRANSLATE(P_FRAMESKIP), 1, 60, 1);
+	obs_property_set_long_description(p, P_TRANSLATE(P_DESC(P_FRAMESKIP)));
+
 	return pr;
 }
 
@@ -231,68 +334,282 @@ void Source::MirrorAddon::enum_active_sources(void *p, obs_source_enum_proc_t en
 	}
 }
 
-Source::Mirror::Mirror(obs_data_t* data, obs_source_t* src) {
+Source::Mirror::Mirror(obs_data_t* data, obs_source_t* src) : m_resolve(false), m_release(false), m_audioMix(nullptr) {
 	m_active = true;
 	m_source = src;
 
 	m_rescale = false;
 	m_width = m_height = 1;
-	m_renderTargetScale = std::make_unique<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-	m_sampler = std::make_shared<gs::sampler>();
+	m_frameOffset = mirror_counter++;
 	m_scalingEffect = obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
 
-	m_audioData.resize(MAX_AUDIO_CHANNELS);
-	for (size_t idx = 0; idx < m_audioData.size(); idx++) {
-		m_audioData[idx].resize(AUDIO_OUTPUT_FRAMES);
-	}
-	m_audioThread = std::thread(std::bind(&Source::Mirror::audio_output_cb, this));
+	m_audioOutput = std::make_unique<obs::audio_forwarder>(m_source);
+
+	signal_handler_t* sh = obs_get_signal_handler();
+	signal_handler_connect(sh, "source_create", on_source_create, this);
+	signal_handler_connect(sh, "source_rename", on_source_rename, this);
+	signal_handler_connect(sh, "source_remove", on_source_remove, this);
+	signal_handler_connect(sh, "source_destroy", on_source_remove, this);
 
 	update(data);
 }
 
 Source::Mirror::~Mirror() {
-	m_killAudioThread = true;
-	m_audioNotify.notify_all();
-	if (m_audioThread.joinable())
-		m_audioThread.join();
+	signal_handler_t* sh = obs_get_signal_handler();
+	signal_handler_disconnect(sh, "source_create", on_source_create, this);
+	signal_handler_disconnect(sh, "source_rename", on_source_rename, this);
+	signal_handler_disconnect(sh, "source_remove", on_source_remove, this);
+	signal_handler_disconnect(sh, "source_destroy", on_source_remove, this);
+
+	// Stop the captures first, they push into the output from other threads.
+	m_audioCapture = nullptr;
+	set_audio_mix(nullptr);
+
+	if ((m_audioOutput->get_drops() > 0) || (m_audioOutput->get_underruns() > 0) || (m_audioOutput->get_overruns() > 0)) {
+		P_LOG_WARNING("<Source::Mirror> '%s' audio: %llu packets dropped, %llu underruns, %llu overruns.",
+			obs_source_get_name(m_source), (unsigned long long)m_audioOutput->get_drops(),
+			(unsigned long long)m_audioOutput->get_underruns(), (unsigned long long)m_audioOutput->get_overruns());
+	}
+	m_audioOutput = nullptr;
+
+	release_target();
+}
+
+obs_source_t* Source::Mirror::get_target() {
+	if (m_mirrorSource) {
+		return m_mirrorSource->get_object();
+	}
+	return m_audioSource;
+}
+
+void Source::Mirror::release_target() {
+	m_audioCapture = nullptr;
+	m_mirrorSource = nullptr;
+	if (m_audioSource) {
+		obs_source_release(m_audioSource);
+		m_audioSource = nullptr;
+	}
+
+	std::unique_lock<std::mutex> ulock(m_mirrorLock);
+	if (m_mirrorWeak) {
+		obs_weak_source_release(m_mirrorWeak);
+		m_mirrorWeak = nullptr;
+	}
+}
+
+void Source::Mirror::on_source_create(void* ptr, calldata_t* data) {
+	Source::Mirror* self = reinterpret_cast<Source::Mirror*>(ptr);
+	obs_source_t* source = reinterpret_cast<obs_source_t*>(calldata_ptr(data, "source"));
+	const char* name = obs_source_get_name(source);
+
+	std::unique_lock<std::mutex> ulock(self->m_mirrorLock);
+	if (!self->m_mirrorWeak && name && (self->m_mirrorName == name)) {
+		self->m_resolve = true;
+	}
+}
+
+void Source::Mirror::on_source_rename(void* ptr, calldata_t* data) {
+	Source::Mirror* self = reinterpret_cast<Source::Mirror*>(ptr);
+	obs_source_t* source = reinterpret_cast<obs_source_t*>(calldata_ptr(data, "source"));
+	const char* name = calldata_string(data, "new_name");
+	if (!name) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> ulock(self->m_mirrorLock);
+	if (self->m_mirrorWeak && obs_weak_source_references_source(self->m_mirrorWeak, source)) {
+		// Follow the source, so that the settings still point at it.
+		self->m_mirrorName = name;
+		ulock.unlock();
+
+		obs_data_t* settings = obs_source_get_settings(self->m_source);
+		obs_data_set_string(settings, P_SOURCE, name);
+		obs_data_release(settings);
+	} else if (!self->m_mirrorWeak && (self->m_mirrorName == name)) {
+		self->m_resolve = true;
+	}
+}
+
+void Source::Mirror::on_source_remove(void* ptr, calldata_t* data) {
+	Source::Mirror* self = reinterpret_cast<Source::Mirror*>(ptr);
+	obs_source_t* source = reinterpret_cast<obs_source_t*>(calldata_ptr(data, "source"));
+
+	std::unique_lock<std::mutex> ulock(self->m_mirrorLock);
+	if (self->m_mirrorWeak && obs_weak_source_references_source(self->m_mirrorWeak, source)) {
+		self->m_release = true;
+	}
 }
 
 uint32_t Source::Mirror::get_width() {
+	if (m_audioOnly) {
+		return 0;
+	}
 	if (m_rescale && m_width > 0 && !m_keepOriginalSize) {
 		return m_width;
 	}
 	if (m_mirrorSource && (m_mirrorSource->get_object() != m_source)) {
-		return obs_source_get_width(m_mirrorSource->get_object());
+		uint32_t x, y, width, height;
+		get_region(x, y, width, height);
+		return width;
 	}
 	return 1;
 }
 
 uint32_t Source::Mirror::get_height() {
+	if (m_audioOnly)
+		return 0;
 	if (m_rescale && m_height > 0 && !m_keepOriginalSize)
 		return m_height;
-	if (m_mirrorSource && (m_mirrorSource->get_object() != m_source))
-		return obs_source_get_height(m_mirrorSource->get_object());
+	if (m_mirrorSource && (m_mirrorSource->get_object() != m_source)) {
+		uint32_t x, y, width, height;
+		get_region(x, y, width, height);
+		return height;
+	}
 	return 1;
 }
 
+bool Source::Mirror::get_region(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height) {
+	uint32_t sw = obs_source_get_width(m_mirrorSource->get_object());
+	uint32_t sh = obs_source_get_height(m_mirrorSource->get_object());
+	x = y = 0;
+	width = sw;
+	height = sh;
+	if (m_crop) {
+		if (((m_cropLeft + m_cropRight) >= sw) || ((m_cropTop + m_cropBottom) >= sh)) {
+			width = height = 0;
+			return false;
+		}
+		x = m_cropLeft;
+		y = m_cropTop;
+		width = sw - m_cropLeft - m_cropRight;
+		height = sh - m_cropTop - m_cropBottom;
+	}
+	return (width > 0) && (height > 0);
+}
+
 void Source::Mirror::update(obs_data_t* data) {
 	// Update selected source.
+	// Audio only mirrors never create a source_texture, so nothing is ever
+	// rendered or allocated on the GPU for them.
 	const char* sourceName = obs_data_get_string(data, P_SOURCE);
-	if (sourceName != m_mirrorName) {
+	bool audioOnly = obs_data_get_bool(data, P_SOURCE_AUDIOONLY);
+	bool changed;
+	{
+		std::unique_lock<std::mutex> ulock(m_mirrorLock);
+		changed = (sourceName != m_mirrorName);
+	}
+	if (changed || (audioOnly != m_audioOnly) || !get_target()) {
+		// Whatever was selected before goes away, even if the new selection
+		// does not exist (yet). Signals pick it up once it does.
+		release_target();
+		{
+			std::unique_lock<std::mutex> ulock(m_mirrorLock);
+			m_mirrorName = sourceName;
+		}
+		m_audioOnly = audioOnly;
+
 		try {
-			m_mirrorSource = std::make_unique<gfx::source_texture>(sourceName, m_source);
-			m_audioCapture = std::make_unique<obs::audio_capture>(m_mirrorSource->get_object());
+			std::unique_ptr<gfx::source_texture> mirror;
+			obs_source_t* audioSource = nullptr;
+			if (audioOnly) {
+				audioSource = obs_get_source_by_name(sourceName);
+				if (!audioSource) {
+					throw std::invalid_argument("No such source.");
+				}
+				if (audioSource == m_source) {
+					obs_source_release(audioSource);
+					throw std::runtime_error("Recursion is not allowed.");
+				}
+			} else {
+				mirror = std::make_unique<gfx::source_texture>(sourceName, m_source);
+			}
+
+			m_mirrorSource = std::move(mirror);
+			m_audioSource = audioSource;
+			{
+				std::unique_lock<std::mutex> ulock(m_mirrorLock);
+				m_mirrorWeak = obs_source_get_weak_source(get_target());
+			}
+
+			m_audioCapture = std::make_unique<obs::audio_capture>(get_target());
 			m_audioCapture->set_callback(std::bind(&Source::Mirror::audio_capture_cb, this,
 				std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-			m_mirrorName = sourceName;
 		} catch (...) {
 		}
 	}
 	m_enableAudio = obs_data_get_bool(data, P_SOURCE_AUDIO);
+	m_audioGain = float_t(obs_data_get_double(data, P_AUDIO_GAIN) / 100.0);
+	m_audioDownmix = obs_data_get_bool(data, P_AUDIO_DOWNMIX);
+	m_audioOutput->set_delay(uint64_t(obs_data_get_int(data, P_AUDIO_DELAY)) * 1000000ull);
+
+	m_frameSkip = max(uint32_t(obs_data_get_int(data, P_FRAMESKIP)), 1u);
+	if (m_frameSkip <= 1) {
+		obs_enter_graphics();
+		m_frameCache = nullptr;
+		obs_leave_graphics();
+	}
+
+	// Sources mixed into the audio.
+	{
+		std::unique_ptr<audio_mix_list_t> inputs = std::make_unique<audio_mix_list_t>();
+		std::unique_lock<std::mutex> ulock(m_audioMixLock);
+		audio_mix_list_t* current = m_audioMix.load();
+		for (size_t idx = 0; idx < AUDIO_MIX_INPUTS; idx++) {
+			const char* name = obs_data_get_string(data, P_AUDIO_MIX_SOURCE[idx]);
+			if (!name || (strlen(name) == 0))
+				continue;
+
+			obs_source_t* source = obs_get_source_by_name(name);
+			if (!source)
+				continue;
+
+			std::shared_ptr<audio_mix_input> input;
+			for (size_t mix = 0; current && (mix < current->size()); mix++) {
+				if ((*current)[mix]->source == source) {
+					input = (*current)[mix];
+					break;
+				}
+			}
+			if (input) {
+				obs_source_release(source);
+			} else {
+				input = std::make_shared<audio_mix_input>();
+				input->source = source;
+				input->capture = std::make_unique<obs::audio_capture>(source);
+				input->capture->set_callback(std::bind(&Source::Mirror::audio_mix_cb, this,
+					std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), input.get());
+			}
+			input->gain = float_t(obs_data_get_double(data, P_AUDIO_MIX_GAIN[idx]) / 100.0);
+			inputs->push_back(input);
+		}
+		ulock.unlock();
+
+		set_audio_mix(inputs.release());
+	}
+
+	// Cropping
+	m_crop = obs_data_get_bool(data, P_CROP);
+	m_cropLeft = uint32_t(obs_data_get_int(data, P_CROP_LEFT));
+	m_cropTop = uint32_t(obs_data_get_int(data, P_CROP_TOP));
+	m_cropRight = uint32_t(obs_data_get_int(data, P_CROP_RIGHT));
+	m_cropBottom = uint32_t(obs_data_get_int(data, P_CROP_BOTTOM));
 
 	// Rescaling
 	m_rescale = obs_data_get_bool(data, P_SCALING);
+	if (m_audioOnly) {
+		m_rescale = false;
+		obs_enter_graphics();
+		m_renderTargetScale = nullptr;
+		m_sampler = nullptr;
+		m_downscaleTargets.clear();
+		m_frameCache = nullptr;
+		obs_leave_graphics();
+	}
 	if (m_rescale) { // Parse rescaling settings.
+		if (!m_sampler) {
+			m_sampler = std::make_shared<gs::sampler>();
+		}
+
 		uint32_t width, height;
 
 		// Read value.
@@ -352,7 +669,7 @@ void Source::Mirror::update(obs_data_t* data) {
 
 void Source::Mirror::activate() {
 	m_active = true;
-	if (!m_mirrorSource) {
+	if (!get_target()) {
 		obs_data_t* ref = obs_source_get_settings(m_source);
 		update(ref);
 		obs_data_release(ref);
@@ -363,59 +680,127 @@ void Source::Mirror::deactivate() {
 	m_active = false;
 }
 
-static inline void mix_audio(float *p_out, float *p_in,
-	size_t pos, size_t count) {
-	register float *out = p_out;
-	register float *in = p_in + pos;
-	register float *end = in + count;
+void Source::Mirror::video_tick(float) {
+	m_frame++;
+	if (((m_frame + m_frameOffset) % m_frameSkip) == 0) {
+		m_renderFrame = true;
+	}
 
-	while (in < end)
-		*(out++) += *(in++);
+	if (m_release.exchange(false)) {
+		release_target();
+	}
+	if (m_resolve.exchange(false)) {
+		obs_data_t* ref = obs_source_get_settings(m_source);
+		update(ref);
+		obs_data_release(ref);
+	}
 }
 
-void Source::Mirror::video_tick(float time) {
-	m_tick += time;
+void Source::Mirror::video_render(gs_effect_t*) {
+	if ((m_width == 0) || (m_height == 0) || !m_mirrorSource || (m_mirrorSource->get_object() == m_source)) {
+		return;
+	}
 
-	if (m_mirrorSource) {
-		m_mirrorName = obs_source_get_name(m_mirrorSource->get_object());
-	} else {
-		if (m_tick > 0.1f) {
-			obs_data_t* ref = obs_source_get_settings(m_source);
-			update(ref);
-			obs_data_release(ref);
-			m_tick -= 0.1f;
-		}
+	if (m_frameSkip <= 1) {
+		render_mirror();
+		return;
+	}
+
+	// Only render on scheduled frames (and only once for all views of it),
+	// the cached frame is drawn otherwise.
+	uint32_t width = get_width(), height = get_height();
+	if ((width == 0) || (height == 0)) {
+		return;
+	}
+	if (!m_frameCache) {
+		m_frameCache = std::make_unique<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		m_renderFrame = true;
+	}
+	if (m_renderFrame || (width != m_frameCacheWidth) || (height != m_frameCacheHeight)) {
+		auto op = m_frameCache->render(width, height);
+		vec4 black; vec4_zero(&black);
+		gs_ortho(0, (float_t)width, 0, (float_t)height, 0, 1);
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+		render_mirror();
+
+		m_frameCacheWidth = width;
+		m_frameCacheHeight = height;
+		m_renderFrame = false;
+	}
+
+	std::shared_ptr<gs::texture> tex;
+	m_frameCache->get_texture(tex);
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	while (gs_effect_loop(effect, "Draw")) {
+		obs_source_draw(tex->get_object(), 0, 0, width, height, false);
 	}
 }
 
-void Source::Mirror::video_render(gs_effect_t*) {
-	if ((m_width == 0) || (m_height == 0) || !m_mirrorSource || (m_mirrorSource->get_object() == m_source)) {
+void Source::Mirror::render_mirror() {
+	// Only the cropped region is ever rendered.
+	uint32_t sx, sy, sw, sh;
+	if (!get_region(sx, sy, sw, sh)) {
 		return;
 	}
 
 	if (m_rescale && m_width > 0 && m_height > 0 && m_scalingEffect) {
-		uint32_t sw, sh;
-		sw = obs_source_get_width(m_mirrorSource->get_object());
-		sh = obs_source_get_height(m_mirrorSource->get_object());
-
 		// Store original Source Texture
 		std::shared_ptr<gs::texture> tex;
 		try {
-			tex = m_mirrorSource->render(sw, sh);
+			tex = m_mirrorSource->render(sx, sy, sw, sh);
 		} catch (...) {
 			return;
 		}
 
+		// Halve the source with a 2x2 box filter until less than half of it
+		// remains to be scaled away, so that the final filter doesn't alias
+		// or read far more texels than it writes. Point scaling is left as is.
+		gs_texture_t* input = tex->get_object();
+		uint32_t iw = sw, ih = sh;
+		size_t step = 0;
+		if (m_sampler->get_filter() != GS_FILTER_POINT) {
+			gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+			while (((iw / 2) >= m_width) || ((ih / 2) >= m_height)) {
+				uint32_t nw = ((iw / 2) >= m_width) ? (iw / 2) : iw;
+				uint32_t nh = ((ih / 2) >= m_height) ? (ih / 2) : ih;
+
+				if (m_downscaleTargets.size() <= step) {
+					m_downscaleTargets.push_back(std::make_unique<gs::rendertarget>(GS_RGBA, GS_ZS_NONE));
+				}
+				gs::rendertarget* rt = m_downscaleTargets[step].get();
+				{
+					// Linear sampling exactly between texels averages them.
+					auto op = rt->render(nw, nh);
+					gs_ortho(0, (float_t)nw, 0, (float_t)nh, 0, 1);
+					gs_blend_state_push();
+					gs_enable_blending(false);
+					while (gs_effect_loop(effect, "Draw")) {
+						obs_source_draw(input, 0, 0, nw, nh, false);
+					}
+					gs_blend_state_pop();
+				}
+
+				input = rt->get_object();
+				iw = nw;
+				ih = nh;
+				step++;
+			}
+		}
+		m_downscaleTargets.resize(step);
+
 		gs_eparam_t *scale_param = gs_effect_get_param_by_name(m_scalingEffect, "base_dimension_i");
 		if (scale_param) {
 			struct vec2 base_res_i = {
-				1.0f / (float)sw,
-				1.0f / (float)sh
+				1.0f / (float)iw,
+				1.0f / (float)ih
 			};
 			gs_effect_set_vec2(scale_param, &base_res_i);
 		}
 
 		if (m_keepOriginalSize) {
+			if (!m_renderTargetScale) {
+				m_renderTargetScale = std::make_unique<gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+			}
 			{
 				vec4 black; vec4_zero(&black);
 				auto op = m_renderTargetScale->render(m_width, m_height);
@@ -424,7 +809,7 @@ void Source::Mirror::video_render(gs_effect_t*) {
 				while (gs_effect_loop(m_scalingEffect, "Draw")) {
 					gs_eparam_t* image = gs_effect_get_param_by_name(m_scalingEffect, "image");
 					gs_effect_set_next_sampler(image, m_sampler->get_object());
-					obs_source_draw(tex->get_object(), 0, 0, m_width, m_height, false);
+					obs_source_draw(input, 0, 0, m_width, m_height, false);
 				}
 			}
 			while (gs_effect_loop(obs_get_base_effect(OBS_EFFECT_DEFAULT), "Draw")) {
@@ -436,59 +821,109 @@ void Source::Mirror::video_render(gs_effect_t*) {
 			while (gs_effect_loop(m_scalingEffect, "Draw")) {
 				gs_eparam_t* image = gs_effect_get_param_by_name(m_scalingEffect, "image");
 				gs_effect_set_next_sampler(image, m_sampler->get_object());
-				obs_source_draw(tex->get_object(), 0, 0, m_width, m_height, false);
+				obs_source_draw(input, 0, 0, m_width, m_height, false);
 			}
 		}
 	} else {
-		obs_source_video_render(m_mirrorSource->get_object());
+		// Plain and cropped mirrors both draw the shared texture, so mirrors of
+		// the same source render its subtree only once per frame.
+		std::shared_ptr<gs::texture> tex;
+		try {
+			tex = m_crop ? m_mirrorSource->render(sx, sy, sw, sh) : m_mirrorSource->render(sw, sh);
+		} catch (...) {
+			return;
+		}
+		while (gs_effect_loop(obs_get_base_effect(OBS_EFFECT_DEFAULT), "Draw")) {
+			obs_source_draw(tex->get_object(), 0, 0, sw, sh, false);
+		}
 	}
 }
 
 void Source::Mirror::audio_capture_cb(void*, const audio_data* audio, bool) {
-	std::unique_lock<std::mutex> ulock(m_audioLock);
 	if (!m_enableAudio) {
 		return;
 	}
 
-	audio_t* aud = obs_get_audio();
-	audio_output_info const* aoi = audio_output_get_info(aud);
+	// Copied once, the output thread uses the same buffer.
+	obs::audio_packet* packet = m_audioOutput->allocate();
+	if (!packet) {
+		return;
+	}
+	packet->assign(audio);
+
+	size_t frames = packet->audio.frames;
+	size_t channels = get_audio_channels(packet->audio.speakers);
+	float_t* planes[MAX_AV_PLANES] = { nullptr };
+	for (size_t plane = 0; plane < channels; plane++) {
+		if (packet->audio.data[plane])
+			planes[plane] = packet->data[plane].data();
+	}
+
+	if (m_audioGain != 1.0f) {
+		for (size_t plane = 0; plane < channels; plane++) {
+			if (planes[plane])
+				util::scale_audio(planes[plane], frames, m_audioGain);
+		}
+	}
 
-	std::bitset<8> layout;
-	for (size_t plane = 0; plane < MAX_AV_PLANES; plane++) {
-		float *samples = (float*)audio->data[plane];
-		if (!samples) {
-			m_audioOutput.data[plane] = nullptr;
-			continue;
+	// Mixed sources are lined up by sample count, not by timestamp: every
+	// packet of the mirrored source takes whatever they queued since. If the
+	// mirrored source produces no audio, nothing is consumed or output.
+	{
+		uint32_t slot = m_audioMixEpoch.enter();
+		audio_mix_list_t* inputs = m_audioMix.load();
+		for (size_t idx = 0; inputs && (idx < inputs->size()); idx++) {
+			audio_mix_input* input = (*inputs)[idx].get();
+			input->fifo.trim(AUDIO_MIX_MAX_FRAMES);
+			input->fifo.mix(planes, channels, frames, input->gain.load());
 		}
-		layout.set(plane);
+		m_audioMixEpoch.leave(slot);
+	}
 
-		memcpy(m_audioData[plane].data(), audio->data[plane], audio->frames * sizeof(float_t));
-		m_audioOutput.data[plane] = (uint8_t*)m_audioData[plane].data();
+	if (m_audioDownmix && (channels > 2)) {
+		bool complete = true;
+		for (size_t plane = 0; plane < channels; plane++) {
+			complete = complete && (planes[plane] != nullptr);
+		}
+		if (complete && util::downmix_audio_stereo(planes, packet->audio.speakers, frames)) {
+			for (size_t plane = 2; plane < MAX_AV_PLANES; plane++) {
+				packet->audio.data[plane] = nullptr;
+			}
+			packet->audio.speakers = SPEAKERS_STEREO;
+		}
 	}
-	m_audioOutput.format = aoi->format;
-	m_audioOutput.frames = audio->frames;
-	m_audioOutput.timestamp = audio->timestamp;
-	m_audioOutput.samples_per_sec = aoi->samples_per_sec;
-	m_audioOutput.speakers = aoi->speakers;
 
-	m_haveAudioOutput = true;
-	m_audioNotify.notify_all();
+	m_audioOutput->push(packet);
 }
 
-void Source::Mirror::audio_output_cb() {
-	std::unique_lock<std::mutex> ulock(m_audioLock);
+void Source::Mirror::audio_mix_cb(void* data, const audio_data* audio, bool) {
+	audio_mix_input* input = reinterpret_cast<audio_mix_input*>(data);
+	size_t channels = get_audio_channels(audio_output_get_info(obs_get_audio())->speakers);
 
-	while (!m_killAudioThread) {
-		if (m_haveAudioOutput) {
-			obs_source_output_audio(m_source, &m_audioOutput);
-			m_haveAudioOutput = false;
-		}
-		m_audioNotify.wait(ulock, [this]() { return m_haveAudioOutput || m_killAudioThread; });
-	}
+	// Samples that don't fit are dropped here, the oldest ones are dropped by
+	// the mirrored source if it falls behind.
+	input->fifo.write(reinterpret_cast<float_t* const*>(audio->data), channels, audio->frames);
+}
+
+void Source::Mirror::set_audio_mix(audio_mix_list_t* inputs) {
+	std::unique_lock<std::mutex> ulock(m_audioMixLock);
+	audio_mix_list_t* previous = m_audioMix.exchange(inputs);
+	m_audioMixEpoch.synchronize();
+	ulock.unlock();
+
+	// Captures that are no longer used unsubscribe here, outside of the lock.
+	delete previous;
+}
+
+Source::Mirror::audio_mix_input::audio_mix_input() : gain(1.0f), fifo(AUDIO_MIX_QUEUE_FRAMES) {}
+
+Source::Mirror::audio_mix_input::~audio_mix_input() {
+	capture = nullptr;
+	obs_source_release(source);
 }
 
 void Source::Mirror::enum_active_sources(obs_source_enum_proc_t enum_callback, void *param) {
-	if (m_mirrorSource) {
-		enum_callback(m_source, m_mirrorSource->get_object(), param);
+	if (get_target()) {
+		enum_callback(m_source, get_target(), param);
 	}
 }
@@ -23,12 +23,14 @@
 #include "gs-sampler.h"
 #include "gfx-source-texture.h"
 #include "obs-audio-capture.h"
+#include "obs-audio-forwarder.h"
+#include "util-audio.h"
+#include "util-epoch.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <obs-source.h>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
 
 namespace Source {
 	class MirrorAddon {
@@ -60,12 +62,26 @@ namespace Source {
 	class Mirror {
 		bool m_active;
 		obs_source_t* m_source = nullptr;
-		float_t m_tick = 0;
 
 		// Input Source
-		std::string m_mirrorName;
 		std::unique_ptr<gfx::source_texture> m_mirrorSource;
 
+		// Tracks the input source through libobs signals, which may arrive
+		// on any thread. They only flag changes for video_tick to apply.
+		std::mutex m_mirrorLock;
+		std::string m_mirrorName;
+		obs_weak_source_t* m_mirrorWeak = nullptr;
+		std::atomic<bool> m_resolve;
+		std::atomic<bool> m_release;
+
+		// Audio only mode, holds the source directly instead of rendering it.
+		bool m_audioOnly = false;
+		obs_source_t* m_audioSource = nullptr;
+
+		// Cropping
+		bool m_crop = false;
+		uint32_t m_cropLeft = 0, m_cropTop = 0, m_cropRight = 0, m_cropBottom = 0;
+
 		// Scaling
 		bool m_rescale = false;
 		uint32_t m_width, m_height;
@@ -73,17 +89,41 @@ namespace Source {
 		bool m_keepOriginalSize = false;
 		std::unique_ptr<gs::rendertarget> m_renderTargetScale;
 		std::shared_ptr<gs::sampler> m_sampler;
+		std::vector<std::unique_ptr<gs::rendertarget>> m_downscaleTargets;
+
+		// Frame Skipping, keeps the last rendered frame between scheduled ones.
+		uint32_t m_frameSkip = 1;
+		uint32_t m_frameOffset = 0;
+		uint64_t m_frame = 0;
+		bool m_renderFrame = true;
+		uint32_t m_frameCacheWidth = 0, m_frameCacheHeight = 0;
+		std::unique_ptr<gs::rendertarget> m_frameCache;
 
 		// Audio
 		bool m_enableAudio = false;
 		std::unique_ptr<obs::audio_capture> m_audioCapture;
-		std::mutex m_audioLock;
-		std::condition_variable m_audioNotify;
-		obs_source_audio m_audioOutput;
-		std::vector<std::vector<float_t>> m_audioData;
-		std::thread m_audioThread;
-		bool m_killAudioThread = false;
-		bool m_haveAudioOutput = false;
+		std::unique_ptr<obs::audio_forwarder> m_audioOutput;
+		float_t m_audioGain = 1.0f;
+		bool m_audioDownmix = false;
+
+		// Additional sources mixed into the mirrored audio. Their samples are
+		// queued by their own audio thread and consumed by the mirrored one.
+		struct audio_mix_input {
+			obs_source_t* source = nullptr;
+			std::atomic<float_t> gain;
+			util::audio_fifo fifo;
+			std::unique_ptr<obs::audio_capture> capture;
+
+			audio_mix_input();
+			~audio_mix_input();
+		};
+		typedef std::vector<std::shared_ptr<audio_mix_input>> audio_mix_list_t;
+
+		// The list is replaced as a whole and read under the epoch, only
+		// changes to it take the lock.
+		std::mutex m_audioMixLock;
+		util::epoch m_audioMixEpoch;
+		std::atomic<audio_mix_list_t*> m_audioMix;
 
 		public:
 		Mirror(obs_data_t*, obs_source_t*);
@@ -98,7 +138,18 @@ namespace Source {
 		void video_tick(float);
 		void video_render(gs_effect_t*);
 		void audio_capture_cb(void* data, const audio_data* audio, bool muted);
-		void audio_output_cb();
+		void audio_mix_cb(void* data, const audio_data* audio, bool muted);
 		void enum_active_sources(obs_source_enum_proc_t, void *);
+
+		private:
+		obs_source_t* get_target();
+		void release_target();
+		void render_mirror();
+		void set_audio_mix(audio_mix_list_t* inputs);
+		bool get_region(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height);
+
+		static void on_source_create(void* ptr, calldata_t* data);
+		static void on_source_rename(void* ptr, calldata_t* data);
+		static void on_source_remove(void* ptr, calldata_t* data);
 	};
 };
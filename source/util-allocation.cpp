@@ -0,0 +1,59 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-allocation.h"
+
+std::vector<size_t> util::assign_slots(const std::vector<uint32_t>& kinds, const std::vector<size_t>& last_use,
+	std::vector<uint32_t>& slot_kinds) {
+	size_t count = kinds.size();
+	std::vector<size_t> slots(count);
+	std::vector<bool> slot_free;
+	slot_kinds.clear();
+
+	// Values by the step after which they are dead. Each value expires exactly
+	// once, so a slot is only freed by the value that currently owns it.
+	std::vector<std::vector<size_t>> expiring(count);
+	for (size_t idx = 0; idx < count; idx++) {
+		if (last_use[idx] < count) {
+			expiring[last_use[idx]].push_back(idx);
+		}
+	}
+
+	for (size_t idx = 0; idx < count; idx++) {
+		if (idx > 0) {
+			for (size_t value : expiring[idx - 1]) {
+				slot_free[slots[value]] = true;
+			}
+		}
+
+		slots[idx] = slot_kinds.size();
+		for (size_t slot = 0; slot < slot_kinds.size(); slot++) {
+			if (slot_free[slot] && (slot_kinds[slot] == kinds[idx])) {
+				slots[idx] = slot;
+				break;
+			}
+		}
+		if (slots[idx] == slot_kinds.size()) {
+			slot_kinds.push_back(kinds[idx]);
+			slot_free.push_back(false);
+		}
+		slot_free[slots[idx]] = false;
+	}
+	return slots;
+}
@@ -0,0 +1,40 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+
+namespace util {
+	/*!
+	 * \brief Share storage between values whose lifetimes don't overlap
+	 *
+	 * Value i is written at step i and read for the last time at step
+	 * last_use[i], which must not be before i. From step last_use[i] + 1 on
+	 * its slot can be handed to a later value of the same kind.
+	 *
+	 * \param kinds Kind of every value, slots are only shared within a kind.
+	 * \param last_use Last step reading every value.
+	 * \param slot_kinds Receives the kind of every slot.
+	 * \return Slot for every value.
+	 */
+	std::vector<size_t> assign_slots(const std::vector<uint32_t>& kinds, const std::vector<size_t>& last_use,
+		std::vector<uint32_t>& slot_kinds);
+}
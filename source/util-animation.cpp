@@ -0,0 +1,228 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-animation.h"
+#include <algorithm>
+#include <stdlib.h>
+
+float_t util::animation::ease(easing curve, float_t t) {
+	switch (curve) {
+		case easing::Step:
+			return (t >= 1.0f) ? 1.0f : 0.0f;
+		case easing::EaseIn:
+			return t * t * t;
+		case easing::EaseOut: {
+			float_t u = 1.0f - t;
+			return 1.0f - u * u * u;
+		}
+		case easing::EaseInOut:
+			return t * t * (3.0f - 2.0f * t);
+		case easing::Linear:
+		default:
+			return t;
+	}
+}
+
+bool util::animation::easing_from_string(std::string text, easing& curve) {
+	if (text == "linear") {
+		curve = easing::Linear;
+	} else if (text == "step") {
+		curve = easing::Step;
+	} else if (text == "in") {
+		curve = easing::EaseIn;
+	} else if (text == "out") {
+		curve = easing::EaseOut;
+	} else if (text == "inout") {
+		curve = easing::EaseInOut;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+void util::animation::track::clear() {
+	m_keyframes.clear();
+	m_last = 0;
+}
+
+void util::animation::track::add(float_t time, float_t value, easing curve) {
+	keyframe kf = { time, value, curve };
+	auto pos = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), kf,
+		[](const keyframe& a, const keyframe& b) {
+		return a.time < b.time;
+	});
+	m_keyframes.insert(pos, kf);
+	m_last = 0;
+}
+
+bool util::animation::track::empty() {
+	return m_keyframes.empty();
+}
+
+float_t util::animation::track::duration() {
+	if (m_keyframes.empty()) {
+		return 0;
+	}
+	return m_keyframes.back().time;
+}
+
+float_t util::animation::track::evaluate(float_t time) {
+	if (m_keyframes.empty()) {
+		return 0;
+	}
+	if (time <= m_keyframes.front().time) {
+		return m_keyframes.front().value;
+	}
+	if (time >= m_keyframes.back().time) {
+		return m_keyframes.back().value;
+	}
+
+	// Playback mostly moves forward a little, so start from the last segment.
+	if ((m_last + 1 >= m_keyframes.size()) || (m_keyframes[m_last].time > time)) {
+		m_last = 0;
+	}
+	while (m_keyframes[m_last + 1].time < time) {
+		m_last++;
+	}
+
+	const keyframe& a = m_keyframes[m_last];
+	const keyframe& b = m_keyframes[m_last + 1];
+	float_t length = b.time - a.time;
+	if (length <= 0) {
+		return b.value;
+	}
+	float_t t = ease(a.curve, (time - a.time) / length);
+	return a.value + (b.value - a.value) * t;
+}
+
+void util::animation::timeline::parse(const std::string& text, const std::vector<std::string>& names,
+	std::vector<std::string>& errors) {
+	m_tracks.clear();
+	m_tracks.resize(names.size());
+	m_duration = 0;
+	seek(0);
+
+	size_t lineNumber = 0;
+	for (size_t begin = 0; begin < text.size(); begin++) {
+		size_t end = text.find('\n', begin);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		lineNumber++;
+		std::string line = "line " + std::to_string(lineNumber);
+
+		// Split into whitespace separated tokens.
+		std::vector<std::string> tokens;
+		for (size_t pos = begin; pos < end;) {
+			size_t first = text.find_first_not_of(" \t\r", pos);
+			if ((first == std::string::npos) || (first >= end)) {
+				break;
+			}
+			size_t last = std::min(text.find_first_of(" \t\r", first), end);
+			tokens.push_back(text.substr(first, last - first));
+			pos = last;
+		}
+		begin = end;
+
+		if (tokens.size() == 0) {
+			continue;
+		}
+		char* timeEnd = nullptr;
+		char* valueEnd = nullptr;
+		float_t time = 0, value = 0;
+		if (tokens.size() >= 3) {
+			time = strtof(tokens[0].c_str(), &timeEnd);
+			value = strtof(tokens[2].c_str(), &valueEnd);
+		}
+		if ((tokens.size() < 3) || (*timeEnd != '\0') || (*valueEnd != '\0')) {
+			errors.push_back("Ignoring malformed keyframe on " + line + ".");
+			continue;
+		}
+
+		easing curve = easing::Linear;
+		if ((tokens.size() >= 4) && !easing_from_string(tokens[3], curve)) {
+			errors.push_back("Unknown easing '" + tokens[3] + "' on " + line + ", using linear.");
+		}
+
+		auto name = std::find(names.begin(), names.end(), tokens[1]);
+		if (name == names.end()) {
+			errors.push_back("Unknown parameter '" + tokens[1] + "' on " + line + ".");
+			continue;
+		}
+
+		track& tr = m_tracks[name - names.begin()];
+		tr.add(time, value, curve);
+		m_duration = std::max(m_duration, tr.duration());
+	}
+}
+
+void util::animation::timeline::set_loop(bool loop) {
+	m_loop = loop;
+	m_finished = false;
+}
+
+bool util::animation::timeline::empty() {
+	for (track& tr : m_tracks) {
+		if (!tr.empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+float_t util::animation::timeline::duration() {
+	return m_duration;
+}
+
+float_t util::animation::timeline::time() {
+	return m_time;
+}
+
+bool util::animation::timeline::finished() {
+	return m_finished;
+}
+
+void util::animation::timeline::seek(float_t time) {
+	m_time = time;
+	m_finished = false;
+}
+
+bool util::animation::timeline::step(float_t seconds) {
+	if (!m_loop && m_finished) {
+		return false;
+	}
+
+	m_time += seconds;
+	if (m_loop && (m_duration > 0)) {
+		m_time = fmodf(m_time, m_duration);
+	} else if (!m_loop && (m_time >= m_duration)) {
+		// Evaluated one last time at the end, after that nothing changes anymore.
+		m_time = m_duration;
+		m_finished = true;
+	}
+	return true;
+}
+
+bool util::animation::timeline::evaluate(size_t index, float_t& value) {
+	if ((index >= m_tracks.size()) || m_tracks[index].empty()) {
+		return false;
+	}
+	value = m_tracks[index].evaluate(m_time);
+	return true;
+}
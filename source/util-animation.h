@@ -0,0 +1,105 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+namespace util {
+	namespace animation {
+		enum class easing : uint8_t {
+			Linear,
+			Step,
+			EaseIn,
+			EaseOut,
+			EaseInOut,
+		};
+
+		// Maps linear progress in [0, 1] onto the easing curve.
+		float_t ease(easing curve, float_t t);
+
+		// Parses "linear", "step", "in", "out" or "inout", false if unknown.
+		bool easing_from_string(std::string text, easing& curve);
+
+		/*!
+		 * \brief Keyframes for a single value
+		 *
+		 * Keyframes are kept sorted by time, each easing curve applies to the
+		 * segment leading up to the next keyframe. Before the first and after
+		 * the last keyframe the value is held.
+		 */
+		class track {
+			public:
+			struct keyframe {
+				float_t time;
+				float_t value;
+				easing curve;
+			};
+
+			void clear();
+			void add(float_t time, float_t value, easing curve = easing::Linear);
+
+			bool empty();
+			float_t duration();
+			float_t evaluate(float_t time);
+
+			private:
+			std::vector<keyframe> m_keyframes;
+			size_t m_last = 0;
+		};
+
+		/*!
+		 * \brief Keyframe text parsed into tracks, and its playback
+		 *
+		 * One keyframe per line: "<time in seconds> <name> <value> [easing]".
+		 * Every name gets a track, the index of the track is the index of the
+		 * name as passed to parse(). Lines that can't be used are skipped and
+		 * described in errors.
+		 */
+		class timeline {
+			public:
+			void parse(const std::string& text, const std::vector<std::string>& names,
+				std::vector<std::string>& errors);
+
+			void set_loop(bool loop);
+			bool empty();
+			float_t duration();
+			float_t time();
+			bool finished();
+
+			// Restarts playback at the given time.
+			void seek(float_t time);
+
+			// Advances playback, false once a non-looping timeline has stopped.
+			bool step(float_t seconds);
+
+			// Value of a track at the current time, false if it has no keyframes.
+			bool evaluate(size_t index, float_t& value);
+
+			private:
+			std::vector<track> m_tracks;
+			float_t m_duration = 0;
+			float_t m_time = 0;
+			bool m_loop = true;
+			bool m_finished = false;
+		};
+	}
+}
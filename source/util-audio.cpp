@@ -0,0 +1,172 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-audio.h"
+#include <algorithm>
+#include <xmmintrin.h>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+void util::mix_audio(float_t* out, const float_t* in, size_t samples, float_t gain) {
+	size_t idx = 0;
+#ifdef __AVX__
+	__m256 gain8 = _mm256_set1_ps(gain);
+	for (; (idx + 8) <= samples; idx += 8) {
+		__m256 value = _mm256_mul_ps(_mm256_loadu_ps(in + idx), gain8);
+		_mm256_storeu_ps(out + idx, _mm256_add_ps(_mm256_loadu_ps(out + idx), value));
+	}
+#endif
+	__m128 gain4 = _mm_set1_ps(gain);
+	for (; (idx + 4) <= samples; idx += 4) {
+		__m128 value = _mm_mul_ps(_mm_loadu_ps(in + idx), gain4);
+		_mm_storeu_ps(out + idx, _mm_add_ps(_mm_loadu_ps(out + idx), value));
+	}
+	for (; idx < samples; idx++) {
+		out[idx] += in[idx] * gain;
+	}
+}
+
+void util::scale_audio(float_t* buffer, size_t samples, float_t gain) {
+	size_t idx = 0;
+#ifdef __AVX__
+	__m256 gain8 = _mm256_set1_ps(gain);
+	for (; (idx + 8) <= samples; idx += 8) {
+		_mm256_storeu_ps(buffer + idx, _mm256_mul_ps(_mm256_loadu_ps(buffer + idx), gain8));
+	}
+#endif
+	__m128 gain4 = _mm_set1_ps(gain);
+	for (; (idx + 4) <= samples; idx += 4) {
+		_mm_storeu_ps(buffer + idx, _mm_mul_ps(_mm_loadu_ps(buffer + idx), gain4));
+	}
+	for (; idx < samples; idx++) {
+		buffer[idx] *= gain;
+	}
+}
+
+bool util::downmix_audio_stereo(float_t* const* planes, speaker_layout layout, size_t frames) {
+	const float_t minus3dB = 0.70710678f;
+
+	// Planes folded into the left and right channel, by libobs channel order.
+	int32_t center = -1, left[2] = { -1, -1 }, right[2] = { -1, -1 };
+	switch (layout) {
+		case SPEAKERS_2POINT1: // FL FR LFE
+			break;
+		case SPEAKERS_4POINT0: // FL FR FC RC
+			center = 2;
+			left[0] = right[0] = 3;
+			break;
+		case SPEAKERS_4POINT1: // FL FR FC LFE RC
+			center = 2;
+			left[0] = right[0] = 4;
+			break;
+		case SPEAKERS_5POINT1: // FL FR FC LFE RL RR
+			center = 2;
+			left[0] = 4;
+			right[0] = 5;
+			break;
+		case SPEAKERS_7POINT1: // FL FR FC LFE RL RR SL SR
+			center = 2;
+			left[0] = 4;
+			right[0] = 5;
+			left[1] = 6;
+			right[1] = 7;
+			break;
+		default:
+			return false;
+	}
+
+	float_t total = 1.0f;
+	if (center >= 0) {
+		mix_audio(planes[0], planes[center], frames, minus3dB);
+		mix_audio(planes[1], planes[center], frames, minus3dB);
+		total += minus3dB;
+	}
+	for (size_t idx = 0; idx < 2; idx++) {
+		if (left[idx] < 0)
+			continue;
+		mix_audio(planes[0], planes[left[idx]], frames, minus3dB);
+		mix_audio(planes[1], planes[right[idx]], frames, minus3dB);
+		total += minus3dB;
+	}
+	scale_audio(planes[0], frames, 1.0f / total);
+	scale_audio(planes[1], frames, 1.0f / total);
+	return true;
+}
+
+util::audio_fifo::audio_fifo(size_t frames) : m_read(0), m_write(0) {
+	size_t size = 1;
+	while (size < frames) {
+		size <<= 1;
+	}
+	m_mask = size - 1;
+	for (size_t plane = 0; plane < MAX_AV_PLANES; plane++) {
+		m_planes[plane].resize(size, 0.0f);
+	}
+}
+
+size_t util::audio_fifo::write(const float_t* const* planes, size_t channels, size_t frames) {
+	size_t write = m_write.load(std::memory_order_relaxed);
+	size_t space = (m_mask + 1) - (write - m_read.load(std::memory_order_acquire));
+	frames = (frames < space) ? frames : space;
+
+	// At most two pieces, before and after the wrap around.
+	size_t offset = write & m_mask;
+	size_t first = ((offset + frames) > (m_mask + 1)) ? ((m_mask + 1) - offset) : frames;
+	for (size_t plane = 0; (plane < channels) && (plane < MAX_AV_PLANES); plane++) {
+		float_t* buffer = m_planes[plane].data();
+		if (planes[plane]) {
+			std::copy(planes[plane], planes[plane] + first, buffer + offset);
+			std::copy(planes[plane] + first, planes[plane] + frames, buffer);
+		} else {
+			std::fill(buffer + offset, buffer + offset + first, 0.0f);
+			std::fill(buffer, buffer + (frames - first), 0.0f);
+		}
+	}
+
+	m_write.store(write + frames, std::memory_order_release);
+	return frames;
+}
+
+size_t util::audio_fifo::mix(float_t* const* planes, size_t channels, size_t frames, float_t gain) {
+	size_t read = m_read.load(std::memory_order_relaxed);
+	size_t stored = m_write.load(std::memory_order_acquire) - read;
+	frames = (frames < stored) ? frames : stored;
+
+	size_t offset = read & m_mask;
+	size_t first = ((offset + frames) > (m_mask + 1)) ? ((m_mask + 1) - offset) : frames;
+	for (size_t plane = 0; (plane < channels) && (plane < MAX_AV_PLANES); plane++) {
+		if (!planes[plane])
+			continue;
+		const float_t* buffer = m_planes[plane].data();
+		mix_audio(planes[plane], buffer + offset, first, gain);
+		mix_audio(planes[plane] + first, buffer, frames - first, gain);
+	}
+
+	m_read.store(read + frames, std::memory_order_release);
+	return frames;
+}
+
+void util::audio_fifo::trim(size_t frames) {
+	size_t read = m_read.load(std::memory_order_relaxed);
+	size_t stored = m_write.load(std::memory_order_acquire) - read;
+	if (stored > frames) {
+		m_read.store(read + (stored - frames), std::memory_order_release);
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+extern "C" {
+#pragma warning( push )
+#pragma warning( disable: 4201 )
+#include <media-io/audio-io.h>
+#pragma warning( pop )
+}
+
+namespace util {
+	// out[i] += in[i] * gain, vectorized with SSE (or AVX if enabled at compile time).
+	void mix_audio(float_t* out, const float_t* in, size_t samples, float_t gain);
+
+	// buffer[i] *= gain, vectorized like mix_audio.
+	void scale_audio(float_t* buffer, size_t samples, float_t gain);
+
+	/*!
+	 * \brief Fold planar surround audio down to stereo in place
+	 *
+	 * Center and surround channels are added to the front channels at -3dB,
+	 * LFE is dropped, and the result is normalized so it can't clip more than
+	 * the input did. Only planes 0 and 1 are valid afterwards.
+	 *
+	 * \param planes Channel planes in libobs order for the layout.
+	 * \param layout Speaker layout of planes.
+	 * \param frames Number of samples per plane.
+	 * \return false if the layout is not supported (mono, stereo, unknown).
+	 */
+	bool downmix_audio_stereo(float_t* const* planes, speaker_layout layout, size_t frames);
+
+	/*!
+	 * \brief Wait-free single-producer/single-consumer FIFO of planar samples
+	 *
+	 * Storage for every plane is allocated once up front, so neither side
+	 * allocates, moves memory around or blocks. Exactly one thread may call
+	 * write(), and exactly one other thread may call mix() and trim().
+	 */
+	class audio_fifo {
+		std::vector<float_t> m_planes[MAX_AV_PLANES];
+		size_t m_mask;
+
+		// Kept on separate cache lines, as each is written by a different thread.
+		alignas(64) std::atomic<size_t> m_read;
+		alignas(64) std::atomic<size_t> m_write;
+
+		public:
+		// Capacity is rounded up to the next power of two frames.
+		audio_fifo(size_t frames);
+
+		audio_fifo(const audio_fifo&) = delete;
+		audio_fifo& operator=(const audio_fifo&) = delete;
+
+		// Producer: Append frames, missing planes are stored as silence. Frames
+		// that don't fit are dropped, the number actually stored is returned.
+		size_t write(const float_t* const* planes, size_t channels, size_t frames);
+
+		// Consumer: Add up to frames stored frames to planes at gain and remove
+		// them, returns how many were mixed. Null planes are skipped.
+		size_t mix(float_t* const* planes, size_t channels, size_t frames, float_t gain);
+
+		// Consumer: Drop the oldest frames until at most frames are left.
+		void trim(size_t frames);
+	};
+}
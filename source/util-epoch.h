@@ -0,0 +1,72 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <atomic>
+#include <thread>
+
+namespace util {
+	/*!
+	 * \brief Epoch based reclamation for one writer and any number of readers
+	 *
+	 * Readers bracket every walk of a shared structure with enter() and
+	 * leave(), neither of which blocks. A writer unlinks an element, calls
+	 * synchronize() and may free the element once it returns, as no reader can
+	 * still see it then. Writers must be serialized by the caller, and a reader
+	 * must never call synchronize() from inside enter()/leave().
+	 */
+	class epoch {
+		std::atomic<uint32_t> m_epoch;
+		std::atomic<uint32_t> m_readers[2];
+
+		public:
+		epoch() : m_epoch(0) {
+			m_readers[0] = 0;
+			m_readers[1] = 0;
+		}
+
+		// Returns the slot to hand to leave().
+		uint32_t enter() {
+			for (;;) {
+				uint32_t current = m_epoch.load();
+				m_readers[current & 1]++;
+				// A flip between the load and the increment would let synchronize()
+				// miss this reader, so only stay if the epoch is still the same.
+				if (m_epoch.load() == current) {
+					return current & 1;
+				}
+				m_readers[current & 1]--;
+			}
+		}
+
+		void leave(uint32_t slot) {
+			m_readers[slot]--;
+		}
+
+		void synchronize() {
+			// Readers entering from now on can't reach anything already unlinked,
+			// so only wait for those that entered in the previous epoch.
+			uint32_t previous = m_epoch++;
+			while (m_readers[previous & 1].load() != 0) {
+				std::this_thread::yield();
+			}
+		}
+	};
+}
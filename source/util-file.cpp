@@ -0,0 +1,129 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-file.h"
+#include <ios>
+extern "C" {
+#pragma warning( push )
+#pragma warning( disable: 4201 )
+#include <util/platform.h>
+#include <util/bmem.h>
+#pragma warning( pop )
+}
+
+#ifdef _WIN32
+#define NOMINMAX
+#define NOINOUT
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+util::mapped_file::mapped_file(std::string path) {
+#ifdef _WIN32
+	wchar_t* wpath = nullptr;
+	os_utf8_to_wcs_ptr(path.c_str(), path.size(), &wpath);
+	if (!wpath)
+		throw std::ios_base::failure(path);
+
+	HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	bfree(wpath);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::ios_base::failure(path);
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		throw std::ios_base::failure(path);
+	}
+	m_size = size_t(size.QuadPart);
+
+	// Empty files can't be mapped, but are still valid files.
+	if (m_size == 0)
+		return;
+
+	m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping) {
+		CloseHandle(file);
+		throw std::ios_base::failure(path);
+	}
+	m_data = reinterpret_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data) {
+		CloseHandle(m_mapping);
+		CloseHandle(file);
+		throw std::ios_base::failure(path);
+	}
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::ios_base::failure(path);
+
+	struct stat st;
+	if (fstat(file, &st) != 0) {
+		close(file);
+		throw std::ios_base::failure(path);
+	}
+
+	// The file may shrink or grow while reading, keep whatever was there
+	// until the first end of file.
+	m_buffer.resize(size_t(st.st_size));
+	size_t offset = 0;
+	while (offset < m_buffer.size()) {
+		ssize_t bytes = read(file, m_buffer.data() + offset, m_buffer.size() - offset);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+			close(file);
+			throw std::ios_base::failure(path);
+		} else if (bytes == 0) {
+			break;
+		}
+		offset += size_t(bytes);
+	}
+	close(file);
+
+	m_buffer.resize(offset);
+	m_size = offset;
+	m_data = m_size > 0 ? m_buffer.data() : nullptr;
+#endif
+}
+
+util::mapped_file::~mapped_file() {
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+#endif
+}
+
+const char* util::mapped_file::data() {
+	return m_data;
+}
+
+size_t util::mapped_file::size() {
+	return m_size;
+}
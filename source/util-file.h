@@ -0,0 +1,60 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace util {
+	/*!
+	 * \brief Read-only memory mapping of a file
+	 *
+	 * Maps the whole file into memory, so that it can be hashed or parsed
+	 * without first copying it into a buffer. Throws std::ios_base::failure
+	 * if the file can't be opened or mapped.
+	 *
+	 * Only Windows actually maps the file, as it refuses to truncate files
+	 * with an open mapping. Elsewhere an editor truncating or rewriting the
+	 * file would turn reads from the mapping into SIGBUS, so the content is
+	 * read into a buffer instead.
+	 */
+	class mapped_file {
+		public:
+		mapped_file(std::string path);
+		virtual ~mapped_file();
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		const char* data();
+		size_t size();
+
+		private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+	#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+	#else
+		std::vector<char> m_buffer;
+	#endif
+	};
+}
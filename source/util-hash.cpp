@@ -0,0 +1,48 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-hash.h"
+
+uint64_t util::hash(const void* data, size_t size, uint64_t seed) {
+	const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+	const uint8_t* end = ptr + size;
+	uint64_t h = seed;
+
+	// Unrolled by eight, shaders and images are rarely tiny.
+	while ((end - ptr) >= 8) {
+		h = (h ^ ptr[0]) * 0x100000001b3ull;
+		h = (h ^ ptr[1]) * 0x100000001b3ull;
+		h = (h ^ ptr[2]) * 0x100000001b3ull;
+		h = (h ^ ptr[3]) * 0x100000001b3ull;
+		h = (h ^ ptr[4]) * 0x100000001b3ull;
+		h = (h ^ ptr[5]) * 0x100000001b3ull;
+		h = (h ^ ptr[6]) * 0x100000001b3ull;
+		h = (h ^ ptr[7]) * 0x100000001b3ull;
+		ptr += 8;
+	}
+	while (ptr < end) {
+		h = (h ^ *ptr) * 0x100000001b3ull;
+		ptr++;
+	}
+	return h;
+}
+
+uint64_t util::hash(std::string text) {
+	return hash(text.data(), text.size());
+}
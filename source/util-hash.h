@@ -0,0 +1,38 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <stddef.h>
+#include <string>
+
+namespace util {
+	/*!
+	 * \brief Fast non-cryptographic 64-bit hash (FNV-1a)
+	 *
+	 * Only meant to detect changed content, never use it for anything
+	 * security related.
+	 *
+	 * \param data Memory to hash.
+	 * \param size Size of the memory in bytes.
+	 * \param seed Previous hash to continue from.
+	 */
+	uint64_t hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+	uint64_t hash(std::string text);
+}
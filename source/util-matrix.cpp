@@ -0,0 +1,91 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-matrix.h"
+#include <emmintrin.h>
+
+util::quaternion util::quaternion::from_axis_angle(float_t x, float_t y, float_t z, float_t angle) {
+	float_t half = angle * 0.5f;
+	float_t sine = sinf(half);
+	return { x * sine, y * sine, z * sine, cosf(half) };
+}
+
+util::quaternion util::combine(const quaternion& first, const quaternion& second) {
+	const quaternion& a = second;
+	const quaternion& b = first;
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+	};
+}
+
+void util::matrix_from_quaternion(matrix4* dst, const quaternion& q) {
+	float_t norm = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+	float_t s = (norm > 0.0f) ? (2.0f / norm) : 0.0f;
+
+	float_t xx = q.x * q.x * s, yy = q.y * q.y * s, zz = q.z * q.z * s;
+	float_t xy = q.x * q.y * s, xz = q.x * q.z * s, yz = q.y * q.z * s;
+	float_t wx = q.w * q.x * s, wy = q.w * q.y * s, wz = q.w * q.z * s;
+
+	dst->x.m = _mm_setr_ps(1.0f - (yy + zz), xy + wz, xz - wy, 0.0f);
+	dst->y.m = _mm_setr_ps(xy - wz, 1.0f - (xx + zz), yz + wx, 0.0f);
+	dst->z.m = _mm_setr_ps(xz + wy, yz - wx, 1.0f - (xx + yy), 0.0f);
+	dst->t.m = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void util::transform_points(vec3* out, const vec3* in, size_t count, const matrix4* m) {
+	// Rows are broadcast per component, so four points can be done at once
+	// once they are transposed into x, y and z registers.
+	__m128 m00 = _mm_set1_ps(m->x.x), m01 = _mm_set1_ps(m->x.y), m02 = _mm_set1_ps(m->x.z);
+	__m128 m10 = _mm_set1_ps(m->y.x), m11 = _mm_set1_ps(m->y.y), m12 = _mm_set1_ps(m->y.z);
+	__m128 m20 = _mm_set1_ps(m->z.x), m21 = _mm_set1_ps(m->z.y), m22 = _mm_set1_ps(m->z.z);
+	__m128 m30 = _mm_set1_ps(m->t.x), m31 = _mm_set1_ps(m->t.y), m32 = _mm_set1_ps(m->t.z);
+
+	size_t idx = 0;
+	for (; (idx + 4) <= count; idx += 4) {
+		__m128 r0 = in[idx].m, r1 = in[idx + 1].m, r2 = in[idx + 2].m, r3 = in[idx + 3].m;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		__m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, m00), _mm_mul_ps(r1, m10)),
+			_mm_add_ps(_mm_mul_ps(r2, m20), m30));
+		__m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, m01), _mm_mul_ps(r1, m11)),
+			_mm_add_ps(_mm_mul_ps(r2, m21), m31));
+		__m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, m02), _mm_mul_ps(r1, m12)),
+			_mm_add_ps(_mm_mul_ps(r2, m22), m32));
+		__m128 w = _mm_setzero_ps();
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		out[idx].m = x;
+		out[idx + 1].m = y;
+		out[idx + 2].m = z;
+		out[idx + 3].m = w;
+	}
+	for (; idx < count; idx++) {
+		__m128 p = in[idx].m;
+		__m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m->x.m), _mm_mul_ps(y, m->y.m)),
+			_mm_add_ps(_mm_mul_ps(z, m->z.m), m->t.m));
+		// vec3 keeps w at zero.
+		out[idx].m = _mm_and_ps(r, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+	}
+}
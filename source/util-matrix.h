@@ -0,0 +1,56 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+
+// OBS
+#include <graphics/vec3.h>
+#include <graphics/matrix4.h>
+
+namespace util {
+	// Rotation as a unit quaternion, laid out like libobs' quat.
+	struct quaternion {
+		float_t x, y, z, w;
+
+		static quaternion from_axis_angle(float_t x, float_t y, float_t z, float_t angle);
+	};
+
+	// Rotation by first, followed by second.
+	quaternion combine(const quaternion& first, const quaternion& second);
+
+	/*!
+	 * \brief Build a rotation matrix from a quaternion
+	 *
+	 * Produces the same matrix4 as libobs' matrix4_from_quat, so chaining
+	 * matrix4_rotate_aa4f calls can be replaced by combining quaternions and
+	 * building the matrix once. The translation is cleared.
+	 */
+	void matrix_from_quaternion(matrix4* dst, const quaternion& q);
+
+	/*!
+	 * \brief Transform points by a matrix, four at a time using SSE
+	 *
+	 * Same result as vec3_transform for every point. In and out may be the
+	 * same array.
+	 */
+	void transform_points(vec3* out, const vec3* in, size_t count, const matrix4* m);
+}
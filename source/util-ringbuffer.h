@@ -0,0 +1,93 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <atomic>
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+
+namespace util {
+	/*!
+	 * \brief Wait-free single-producer/single-consumer ring of reusable elements
+	 *
+	 * All elements are constructed up front and filled in place, so neither
+	 * side ever allocates or blocks. Exactly one thread may call acquire() and
+	 * commit(), and exactly one other thread may call front() and pop().
+	 */
+	template<typename T>
+	class spsc_ring {
+		std::vector<T> m_elements;
+		size_t m_mask;
+
+		// Kept on separate cache lines, as each is written by a different thread.
+		alignas(64) std::atomic<size_t> m_head;
+		alignas(64) std::atomic<size_t> m_tail;
+
+		public:
+		// Capacity is rounded up to a power of two, all elements start as copies of prototype.
+		spsc_ring(size_t capacity, const T& prototype = T()) : m_head(0), m_tail(0) {
+			size_t size = 1;
+			while (size < capacity) {
+				size <<= 1;
+			}
+			m_elements.resize(size, prototype);
+			m_mask = size - 1;
+		}
+
+		spsc_ring(const spsc_ring&) = delete;
+		spsc_ring& operator=(const spsc_ring&) = delete;
+
+		// Producer: Element to fill next, or nullptr if full.
+		T* acquire() {
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if ((tail - m_head.load(std::memory_order_acquire)) > m_mask) {
+				return nullptr;
+			}
+			return &m_elements[tail & m_mask];
+		}
+
+		// Producer: Publish the element returned by acquire().
+		void commit() {
+			m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Consumer: Oldest published element, or nullptr if empty.
+		T* front() {
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+			return &m_elements[head & m_mask];
+		}
+
+		// Consumer: Hand the element returned by front() back to the producer.
+		void pop() {
+			m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		bool empty() {
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+
+		size_t capacity() {
+			return m_elements.size();
+		}
+	};
+}
@@ -0,0 +1,67 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-threadpool.h"
+
+util::threadpool::threadpool(size_t workers) {
+	if (workers == 0) {
+		workers = std::thread::hardware_concurrency();
+		workers = (workers > 2 ? workers / 2 : 1);
+	}
+
+	m_workers.reserve(workers);
+	for (size_t idx = 0; idx < workers; idx++) {
+		m_workers.emplace_back(&threadpool::work, this);
+	}
+}
+
+util::threadpool::~threadpool() {
+	{
+		std::unique_lock<std::mutex> ulock(m_lock);
+		m_stop = true;
+	}
+	m_signal.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
+
+void util::threadpool::push(std::function<void()> task) {
+	{
+		std::unique_lock<std::mutex> ulock(m_lock);
+		m_tasks.push_back(std::move(task));
+	}
+	m_signal.notify_one();
+}
+
+void util::threadpool::work() {
+	for (;;) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> ulock(m_lock);
+			m_signal.wait(ulock, [this] { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty()) {
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
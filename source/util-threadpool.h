@@ -0,0 +1,54 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+	/*!
+	 * \brief Fixed size pool of worker threads
+	 *
+	 * Tasks are run in the order they were pushed, by whichever worker is
+	 * free first. Pending tasks are still run when the pool is destroyed.
+	 */
+	class threadpool {
+		public:
+		threadpool(size_t workers = 0);
+		virtual ~threadpool();
+
+		threadpool(const threadpool&) = delete;
+		threadpool& operator=(const threadpool&) = delete;
+
+		void push(std::function<void()> task);
+
+		private:
+		void work();
+
+		std::vector<std::thread> m_workers;
+		std::list<std::function<void()>> m_tasks;
+		std::mutex m_lock;
+		std::condition_variable m_signal;
+		bool m_stop = false;
+	};
+}
@@ -0,0 +1,173 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-triangulation.h"
+#include <math.h>
+
+static const float_t epsilon = 1e-7f;
+
+static inline float_t cross(const vec2& a, const vec2& b, const vec2& c) {
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Points on an edge count as inside, otherwise a clipped ear could touch
+// the remaining outline.
+static inline bool equal(const vec2& a, const vec2& b) {
+	return (fabsf(a.x - b.x) <= epsilon) && (fabsf(a.y - b.y) <= epsilon);
+}
+
+// Edges a-b and c-d cross each other somewhere other than at their ends.
+static inline bool crossing(const vec2& a, const vec2& b, const vec2& c, const vec2& d) {
+	float_t c1 = cross(a, b, c), c2 = cross(a, b, d);
+	float_t c3 = cross(c, d, a), c4 = cross(c, d, b);
+	return (((c1 > epsilon) && (c2 < -epsilon)) || ((c1 < -epsilon) && (c2 > epsilon)))
+		&& (((c3 > epsilon) && (c4 < -epsilon)) || ((c3 < -epsilon) && (c4 > epsilon)));
+}
+
+static inline bool inside(const vec2& p, const vec2& a, const vec2& b, const vec2& c, float_t orientation) {
+	return (cross(a, b, p) * orientation >= -epsilon)
+		&& (cross(b, c, p) * orientation >= -epsilon)
+		&& (cross(c, a, p) * orientation >= -epsilon);
+}
+
+bool util::triangulate(const vec2* points, size_t count, std::vector<uint32_t>& indices) {
+	indices.clear();
+	if ((points == nullptr) || (count < 3)) {
+		return false;
+	}
+
+	// Repeated points would make zero length edges, which touch their
+	// neighbours' neighbours.
+	std::vector<uint32_t> remaining;
+	remaining.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		if (remaining.empty() || !equal(points[remaining.back()], points[i])) {
+			remaining.push_back(uint32_t(i));
+		}
+	}
+	while ((remaining.size() > 1) && equal(points[remaining.back()], points[remaining.front()])) {
+		remaining.pop_back();
+	}
+
+	// Points on a straight edge don't change the outline, and removing one
+	// can make its neighbours collinear too.
+	for (bool changed = true; changed && (remaining.size() >= 3);) {
+		changed = false;
+		for (size_t i = 0; (i < remaining.size()) && (remaining.size() >= 3);) {
+			size_t n = remaining.size();
+			const vec2& a = points[remaining[(i + n - 1) % n]];
+			const vec2& b = points[remaining[i]];
+			const vec2& c = points[remaining[(i + 1) % n]];
+			if (fabsf(cross(a, b, c)) <= epsilon) {
+				remaining.erase(remaining.begin() + i);
+				changed = true;
+			} else {
+				i++;
+			}
+		}
+	}
+	size_t size = remaining.size();
+	if (size < 3) {
+		return false;
+	}
+
+	// Winding order from the signed area, ears must turn the same way.
+	float_t area = 0;
+	for (size_t i = 0, j = size - 1; i < size; j = i++) {
+		const vec2& a = points[remaining[j]];
+		const vec2& b = points[remaining[i]];
+		area += a.x * b.y - b.x * a.y;
+	}
+	if (fabsf(area) <= epsilon) {
+		return false;
+	}
+	float_t orientation = area > 0 ? 1.0f : -1.0f;
+
+	// Ear clipping assumes a simple polygon, so reject crossing edges up front.
+	for (size_t i = 0; i < size; i++) {
+		const vec2& a = points[remaining[i]];
+		const vec2& b = points[remaining[(i + 1) % size]];
+		for (size_t j = i + 2; j < size; j++) {
+			if ((i == 0) && (j == size - 1)) {
+				continue;
+			}
+			if (crossing(a, b, points[remaining[j]], points[remaining[(j + 1) % size]])) {
+				return false;
+			}
+		}
+	}
+	indices.reserve((size - 2) * 3);
+
+	// Every pass over the outline must clip something, otherwise the outline
+	// touches itself in a way the checks above don't catch.
+	size_t cursor = 0, misses = 0;
+	while (remaining.size() > 3) {
+		size = remaining.size();
+		if (misses > size) {
+			indices.clear();
+			return false;
+		}
+
+		cursor %= size;
+		uint32_t prev = remaining[(cursor + size - 1) % size];
+		uint32_t curr = remaining[cursor];
+		uint32_t next = remaining[(cursor + 1) % size];
+		const vec2& a = points[prev];
+		const vec2& b = points[curr];
+		const vec2& c = points[next];
+
+		float_t turn = cross(a, b, c) * orientation;
+		if (fabsf(turn) <= epsilon) {
+			// Collinear, removing it doesn't change the outline.
+			remaining.erase(remaining.begin() + cursor);
+			misses = 0;
+			continue;
+		} else if (turn < 0) {
+			// Reflex vertex, can't be an ear.
+			cursor++;
+			misses++;
+			continue;
+		}
+
+		bool ear = true;
+		for (uint32_t idx : remaining) {
+			if ((idx == prev) || (idx == curr) || (idx == next)) {
+				continue;
+			}
+			if (inside(points[idx], a, b, c, orientation)) {
+				ear = false;
+				break;
+			}
+		}
+		if (!ear) {
+			cursor++;
+			misses++;
+			continue;
+		}
+
+		indices.insert(indices.end(), { prev, curr, next });
+		remaining.erase(remaining.begin() + cursor);
+		misses = 0;
+	}
+
+	if (fabsf(cross(points[remaining[0]], points[remaining[1]], points[remaining[2]])) > epsilon) {
+		indices.insert(indices.end(), { remaining[0], remaining[1], remaining[2] });
+	}
+	return !indices.empty();
+}
@@ -0,0 +1,43 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+
+// OBS
+#include <graphics/vec2.h>
+
+namespace util {
+	/*!
+	 * \brief Triangulate a simple polygon by ear clipping
+	 *
+	 * Works for convex and concave polygons in either winding order.
+	 * Repeated and collinear points are dropped. O(n^2) per ear, which is
+	 * fine for the few points a shape has.
+	 *
+	 * \param points Outline of the polygon.
+	 * \param count Number of points in the outline.
+	 * \param indices Receives three indices per triangle.
+	 * \return false if the outline has no area or two of its edges cross, in
+	 *  which case indices holds no triangles.
+	 */
+	bool triangulate(const vec2* points, size_t count, std::vector<uint32_t>& indices);
+}
@@ -0,0 +1,101 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-allocation.h"
+
+// No value may share a slot with a value written while it is still read, and
+// slots are only shared between values of the same kind.
+static void check_slots(const std::vector<uint32_t>& kinds, const std::vector<size_t>& last_use,
+	const std::vector<size_t>& slots, const std::vector<uint32_t>& slot_kinds) {
+	TEST_CHECK(slots.size() == kinds.size());
+	for (size_t idx = 0; idx < slots.size(); idx++) {
+		TEST_CHECK(slots[idx] < slot_kinds.size());
+		TEST_CHECK(slot_kinds[slots[idx]] == kinds[idx]);
+		for (size_t later = idx + 1; (later <= last_use[idx]) && (later < slots.size()); later++) {
+			TEST_CHECK(slots[later] != slots[idx]);
+		}
+	}
+}
+
+// Every value is read by the next one only.
+static void test_chain() {
+	for (size_t length = 1; length <= 8; length++) {
+		std::vector<uint32_t> kinds(length, 0), slot_kinds;
+		std::vector<size_t> last_use(length);
+		for (size_t idx = 0; idx < length; idx++) {
+			last_use[idx] = idx + 1;
+		}
+
+		std::vector<size_t> slots = util::assign_slots(kinds, last_use, slot_kinds);
+		check_slots(kinds, last_use, slots, slot_kinds);
+		TEST_CHECK(slot_kinds.size() == (length > 1 ? 2 : 1));
+	}
+}
+
+// P0 -> P1 -> P2 -> P3 -> P4, where P1 also reads P0 and the last read of P1
+// is P4. P2 takes P0's slot, and P3 must not take it back while P2 is live.
+static void test_chain_with_skip() {
+	std::vector<uint32_t> kinds(5, 0), slot_kinds;
+	std::vector<size_t> last_use = {1, 4, 3, 4, 5};
+
+	std::vector<size_t> slots = util::assign_slots(kinds, last_use, slot_kinds);
+	check_slots(kinds, last_use, slots, slot_kinds);
+	TEST_CHECK(slots[2] == slots[0]);
+	TEST_CHECK(slots[3] != slots[2]);
+}
+
+static void test_kinds() {
+	std::vector<uint32_t> kinds = {0, 1, 0, 1, 0, 1}, slot_kinds;
+	std::vector<size_t> last_use = {1, 2, 3, 4, 5, 6};
+
+	std::vector<size_t> slots = util::assign_slots(kinds, last_use, slot_kinds);
+	check_slots(kinds, last_use, slots, slot_kinds);
+	TEST_CHECK(slot_kinds.size() == 2);
+}
+
+// Pseudo-random graphs, every value being read by some later values.
+static void test_random() {
+	uint32_t state = 12345;
+	auto next = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	};
+
+	for (size_t round = 0; round < 1000; round++) {
+		size_t count = 1 + next() % 16;
+		std::vector<uint32_t> kinds(count), slot_kinds;
+		std::vector<size_t> last_use(count);
+		for (size_t idx = 0; idx < count; idx++) {
+			kinds[idx] = next() % 2;
+			last_use[idx] = idx + 1 + next() % (count - idx);
+		}
+
+		std::vector<size_t> slots = util::assign_slots(kinds, last_use, slot_kinds);
+		check_slots(kinds, last_use, slots, slot_kinds);
+	}
+}
+
+int main(int, char**) {
+	test_chain();
+	test_chain_with_skip();
+	test_kinds();
+	test_random();
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-animation.h"
+#include "util-matrix.h"
+
+using namespace util::animation;
+
+static const double pi = 3.1415926535897932384626433832795;
+
+static void test_ease() {
+	easing curves[] = {easing::Linear, easing::Step, easing::EaseIn, easing::EaseOut, easing::EaseInOut};
+	for (easing curve : curves) {
+		TEST_CHECK_NEAR(ease(curve, 0.0f), 0.0, 0.0001);
+		TEST_CHECK_NEAR(ease(curve, 1.0f), 1.0, 0.0001);
+	}
+	TEST_CHECK_NEAR(ease(easing::Linear, 0.25f), 0.25, 0.0001);
+	TEST_CHECK_NEAR(ease(easing::Step, 0.99f), 0.0, 0.0001);
+	TEST_CHECK(ease(easing::EaseIn, 0.5f) < 0.5f);
+	TEST_CHECK(ease(easing::EaseOut, 0.5f) > 0.5f);
+	TEST_CHECK_NEAR(ease(easing::EaseInOut, 0.5f), 0.5, 0.0001);
+
+	easing curve = easing::Linear;
+	TEST_CHECK(easing_from_string("inout", curve) && (curve == easing::EaseInOut));
+	TEST_CHECK(easing_from_string("step", curve) && (curve == easing::Step));
+	TEST_CHECK(!easing_from_string("bounce", curve) && (curve == easing::Step));
+}
+
+static void test_track() {
+	track tr;
+	TEST_CHECK(tr.empty());
+	TEST_CHECK_NEAR(tr.duration(), 0.0, 0.0001);
+	TEST_CHECK_NEAR(tr.evaluate(1.0f), 0.0, 0.0001);
+
+	// Added out of order, kept sorted.
+	tr.add(2.0f, 30.0f);
+	tr.add(0.5f, 10.0f);
+	tr.add(1.0f, 20.0f, easing::Step);
+	TEST_CHECK(!tr.empty());
+	TEST_CHECK_NEAR(tr.duration(), 2.0, 0.0001);
+
+	// Held before the first and after the last keyframe.
+	TEST_CHECK_NEAR(tr.evaluate(0.0f), 10.0, 0.0001);
+	TEST_CHECK_NEAR(tr.evaluate(5.0f), 30.0, 0.0001);
+
+	// Linear segment, then a step segment.
+	TEST_CHECK_NEAR(tr.evaluate(0.75f), 15.0, 0.0001);
+	TEST_CHECK_NEAR(tr.evaluate(1.5f), 20.0, 0.0001);
+	TEST_CHECK_NEAR(tr.evaluate(2.0f), 30.0, 0.0001);
+
+	// Seeking backwards after playing forward.
+	TEST_CHECK_NEAR(tr.evaluate(0.6f), 12.0, 0.0001);
+
+	// Keyframes at the same time jump straight to the later value.
+	tr.clear();
+	tr.add(0.0f, 0.0f);
+	tr.add(1.0f, 5.0f);
+	tr.add(1.0f, 7.0f);
+	tr.add(2.0f, 7.0f);
+	TEST_CHECK_NEAR(tr.evaluate(0.5f), 2.5, 0.0001);
+	TEST_CHECK_NEAR(tr.evaluate(1.5f), 7.0, 0.0001);
+}
+
+static void test_timeline() {
+	const std::vector<std::string> names = {"position.x", "rotation.z", "scale.x"};
+	std::vector<std::string> errors;
+	timeline tl;
+
+	// Broken lines are reported and skipped, an unknown easing falls back to linear.
+	tl.parse("garbage\n0 size 1\n0 rotation.z 0 bounce\n\n1 rotation.z abc\n", names, errors);
+	TEST_CHECK(errors.size() == 4);
+	float_t value = 0;
+	TEST_CHECK(!tl.empty());
+	TEST_CHECK(!tl.evaluate(0, value));
+	TEST_CHECK(tl.evaluate(1, value));
+	TEST_CHECK(!tl.evaluate(3, value));
+
+	// Quarter turn around Z while moving half the width to the right.
+	errors.clear();
+	tl.parse("0 rotation.z 0\n1 rotation.z 90\n0 position.x 0\r\n1 position.x 50 linear\n", names, errors);
+	TEST_CHECK(errors.empty());
+	TEST_CHECK_NEAR(tl.duration(), 1.0, 0.0001);
+	tl.set_loop(false);
+
+	for (size_t step = 1; step <= 4; step++) {
+		TEST_CHECK(tl.step(0.25f));
+		float_t t = float_t(step) * 0.25f;
+		TEST_CHECK_NEAR(tl.time(), t, 0.0001);
+		TEST_CHECK(tl.finished() == (step == 4));
+
+		// Applied the way the Transform filter does.
+		float_t x = 0, angle = 0, scale = 1;
+		TEST_CHECK(tl.evaluate(0, x));
+		TEST_CHECK(tl.evaluate(1, angle));
+		TEST_CHECK(!tl.evaluate(2, scale));
+		x /= 100.0f;
+		angle = float_t(angle / 180.0 * pi);
+
+		matrix4 m;
+		util::matrix_from_quaternion(&m, util::quaternion::from_axis_angle(0, 0, 1, angle));
+		vec4_set(&m.t, x, 0, 0, 1);
+		float_t c = cosf(angle), s = sinf(angle);
+		TEST_CHECK_NEAR(m.x.x, c, 0.0001);
+		TEST_CHECK_NEAR(m.x.y, s, 0.0001);
+		TEST_CHECK_NEAR(m.y.x, -s, 0.0001);
+		TEST_CHECK_NEAR(m.y.y, c, 0.0001);
+		TEST_CHECK_NEAR(m.z.z, 1.0, 0.0001);
+
+		// Corners in the order top left, top right, bottom left, bottom right.
+		vec3 corners[4];
+		vec3_set(&corners[0], -1, -1, 0);
+		vec3_set(&corners[1], 1, -1, 0);
+		vec3_set(&corners[2], -1, 1, 0);
+		vec3_set(&corners[3], 1, 1, 0);
+		util::transform_points(corners, corners, 4, &m);
+		TEST_CHECK_NEAR(corners[1].x, c + s + 0.5f * t, 0.0001);
+		TEST_CHECK_NEAR(corners[1].y, s - c, 0.0001);
+		TEST_CHECK_NEAR(corners[1].z, 0.0, 0.0001);
+		if (step == 2) {
+			// 45 degrees, the top left corner points straight up.
+			TEST_CHECK_NEAR(corners[0].x, 0.25, 0.0001);
+			TEST_CHECK_NEAR(corners[0].y, -sqrt(2.0), 0.0001);
+		} else if (step == 4) {
+			TEST_CHECK_NEAR(corners[0].x, 1.5, 0.0001);
+			TEST_CHECK_NEAR(corners[0].y, -1.0, 0.0001);
+			TEST_CHECK_NEAR(corners[1].x, 1.5, 0.0001);
+			TEST_CHECK_NEAR(corners[1].y, 1.0, 0.0001);
+			TEST_CHECK_NEAR(corners[3].x, -0.5, 0.0001);
+			TEST_CHECK_NEAR(corners[3].y, 1.0, 0.0001);
+		}
+	}
+
+	// Stopped at the end until playback is restarted.
+	TEST_CHECK(!tl.step(0.25f));
+	TEST_CHECK_NEAR(tl.time(), 1.0, 0.0001);
+	tl.set_loop(false);
+	TEST_CHECK(tl.step(0.25f));
+	TEST_CHECK(tl.finished());
+
+	// Looping wraps around.
+	tl.set_loop(true);
+	tl.seek(0);
+	TEST_CHECK(tl.step(1.25f));
+	TEST_CHECK_NEAR(tl.time(), 0.25, 0.0001);
+	TEST_CHECK(tl.evaluate(1, value));
+	TEST_CHECK_NEAR(value, 22.5, 0.0001);
+}
+
+int main(int, char**) {
+	test_ease();
+	test_track();
+	test_timeline();
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-audio.h"
+#include <chrono>
+#include <vector>
+
+static void test_mix_scale() {
+	// Odd lengths, so the vector and the scalar tails both run.
+	for (size_t samples = 0; samples < 40; samples++) {
+		std::vector<float_t> out(samples), in(samples);
+		for (size_t idx = 0; idx < samples; idx++) {
+			out[idx] = float_t(idx);
+			in[idx] = float_t(idx) * 0.5f;
+		}
+		util::mix_audio(out.data(), in.data(), samples, 2.0f);
+		for (size_t idx = 0; idx < samples; idx++) {
+			TEST_CHECK_NEAR(out[idx], float_t(idx) * 2.0f, 0.0001);
+		}
+		util::scale_audio(out.data(), samples, 0.25f);
+		for (size_t idx = 0; idx < samples; idx++) {
+			TEST_CHECK_NEAR(out[idx], float_t(idx) * 0.5f, 0.0001);
+		}
+	}
+}
+
+static void test_downmix() {
+	// 4.1 is FL FR FC LFE RC, the LFE must not end up in the front channels.
+	std::vector<float_t> data[5];
+	float_t* planes[5];
+	for (size_t plane = 0; plane < 5; plane++) {
+		data[plane].assign(16, plane == 3 ? 1.0f : 0.0f);
+		planes[plane] = data[plane].data();
+	}
+	TEST_CHECK(util::downmix_audio_stereo(planes, SPEAKERS_4POINT1, 16));
+	TEST_CHECK_NEAR(data[0][0], 0.0, 0.0001);
+	TEST_CHECK_NEAR(data[1][0], 0.0, 0.0001);
+
+	data[4].assign(16, 1.0f);
+	TEST_CHECK(util::downmix_audio_stereo(planes, SPEAKERS_4POINT1, 16));
+	TEST_CHECK(data[0][0] > 0.0f);
+	TEST_CHECK_NEAR(data[0][0], data[1][0], 0.0001);
+
+	TEST_CHECK(!util::downmix_audio_stereo(planes, SPEAKERS_STEREO, 16));
+}
+
+static void test_fifo() {
+	util::audio_fifo fifo(6);
+	float_t in[8], out[8];
+	const float_t* in_planes[2] = {in, nullptr};
+	float_t* out_planes[2] = {out, out};
+
+	// Capacity is 8 frames, the rest is dropped.
+	for (size_t idx = 0; idx < 8; idx++) {
+		in[idx] = float_t(idx + 1);
+	}
+	TEST_CHECK(fifo.write(in_planes, 2, 5) == 5);
+	TEST_CHECK(fifo.write(in_planes, 2, 5) == 3);
+
+	// Reading wraps around, missing planes come back as silence.
+	for (size_t round = 0; round < 4; round++) {
+		float_t left[3] = {0, 0, 0}, right[3] = {0, 0, 0};
+		float_t* planes[2] = {left, right};
+		TEST_CHECK(fifo.mix(planes, 2, 3, 1.0f) == 3);
+		TEST_CHECK(right[0] == 0.0f);
+		TEST_CHECK(fifo.write(in_planes, 2, 3) == 3);
+		TEST_CHECK(left[0] != 0.0f);
+	}
+
+	fifo.trim(2);
+	for (size_t idx = 0; idx < 8; idx++) {
+		out[idx] = 0;
+	}
+	TEST_CHECK(fifo.mix(out_planes, 1, 8, 1.0f) == 2);
+	TEST_CHECK(out[0] == 2.0f);
+	TEST_CHECK(out[1] == 3.0f);
+	TEST_CHECK(fifo.mix(out_planes, 1, 8, 1.0f) == 0);
+}
+
+// Throughput of the kernels the audio threads run on a single thread, for
+// packets of the usual libobs size. Counts every sample of every channel read.
+template<typename F>
+static void bench(const char* name, size_t frames, size_t channels, F fn) {
+	const size_t rounds = 20000;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t round = 0; round < rounds; round++) {
+		fn();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double samples = double(rounds * frames * channels);
+	printf("%-24s %10.1f Msamples/s per thread\n", name, samples / seconds / 1000000.0);
+}
+
+static void bench_kernels() {
+	const size_t frames = 1024;
+	std::vector<float_t> data[6];
+	float_t* planes[6];
+	for (size_t plane = 0; plane < 6; plane++) {
+		data[plane].assign(frames, 0.25f);
+		planes[plane] = data[plane].data();
+	}
+	util::audio_fifo fifo(frames * 8);
+
+	bench("mix_audio (stereo)", frames, 2, [&]() {
+		util::mix_audio(planes[0], planes[2], frames, 0.5f);
+		util::mix_audio(planes[1], planes[3], frames, 0.5f);
+	});
+	bench("scale_audio (stereo)", frames, 2, [&]() {
+		util::scale_audio(planes[0], frames, 0.5f);
+		util::scale_audio(planes[1], frames, 2.0f);
+	});
+	bench("downmix_audio_stereo 5.1", frames, 6, [&]() {
+		util::downmix_audio_stereo(planes, SPEAKERS_5POINT1, frames);
+	});
+	bench("audio_fifo (stereo)", frames, 2, [&]() {
+		fifo.write(planes, 2, frames);
+		fifo.mix(planes, 2, frames, 0.5f);
+	});
+}
+
+int main(int, char**) {
+	test_mix_scale();
+	test_downmix();
+	test_fifo();
+	bench_kernels();
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-epoch.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define NODE_ALIVE 0xA11FE5u
+#define NODE_DEAD 0xDEADu
+
+struct node {
+	std::atomic<uint32_t> magic;
+	std::atomic<node*> next;
+};
+
+// Readers walk a list while a writer keeps linking in new nodes and unlinking,
+// poisoning and freeing old ones. A reader seeing a poisoned node means the
+// writer freed something a walk could still reach.
+static void test_churn() {
+	util::epoch epoch;
+	std::atomic<node*> head(nullptr);
+	std::atomic<bool> running(true);
+	std::atomic<bool> failed(false);
+
+	std::vector<std::thread> readers;
+	for (size_t idx = 0; idx < 3; idx++) {
+		readers.emplace_back([&]() {
+			while (running.load()) {
+				uint32_t slot = epoch.enter();
+				for (node* nd = head.load(); nd != nullptr; nd = nd->next.load()) {
+					if (nd->magic.load() != NODE_ALIVE) {
+						failed = true;
+					}
+				}
+				epoch.leave(slot);
+			}
+		});
+	}
+
+	for (size_t round = 0; round < 20000; round++) {
+		node* nd = new node();
+		nd->magic = NODE_ALIVE;
+		nd->next = head.load();
+		head = nd;
+
+		// Keep a few nodes around and drop the oldest one.
+		size_t length = 0;
+		node* prev = nullptr;
+		node* last = head.load();
+		for (; last->next.load() != nullptr; last = last->next.load()) {
+			prev = last;
+			length++;
+		}
+		if (length < 4) {
+			continue;
+		}
+		prev->next = nullptr;
+
+		epoch.synchronize();
+		last->magic = NODE_DEAD;
+		delete last;
+	}
+
+	running = false;
+	for (std::thread& thread : readers) {
+		thread.join();
+	}
+	for (node* nd = head.load(); nd != nullptr;) {
+		node* next = nd->next.load();
+		delete nd;
+		nd = next;
+	}
+	TEST_CHECK(!failed.load());
+}
+
+int main(int, char**) {
+	test_churn();
+	return 0;
+}
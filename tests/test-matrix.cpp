@@ -0,0 +1,114 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-matrix.h"
+#include <vector>
+
+// Axes in the order the Transform filter applies them, for every RotationOrder.
+static const struct {
+	const char* name;
+	size_t axes[3];
+} rotation_orders[] = {
+	{"XYZ", {0, 1, 2}},
+	{"XZY", {0, 2, 1}},
+	{"YXZ", {1, 0, 2}},
+	{"YZX", {1, 2, 0}},
+	{"ZXY", {2, 0, 1}},
+	{"ZYX", {2, 1, 0}},
+};
+
+static void check_matrix(const matrix4& a, const matrix4& b) {
+	const float_t* pa = reinterpret_cast<const float_t*>(&a);
+	const float_t* pb = reinterpret_cast<const float_t*>(&b);
+	for (size_t idx = 0; idx < 16; idx++) {
+		TEST_CHECK_NEAR(pa[idx], pb[idx], 0.0001);
+	}
+}
+
+// Combined quaternions must give the same matrix as chaining
+// matrix4_rotate_aa4f like the filter used to.
+static void test_rotation_orders() {
+	const float_t angles[][3] = {
+		{0.0f, 0.0f, 0.0f},
+		{0.3f, 0.0f, 0.0f},
+		{0.5f, -1.2f, 2.0f},
+		{3.1f, 1.5707963f, -0.7f},
+		{-2.5f, 0.25f, 6.0f},
+	};
+
+	for (auto& order : rotation_orders) {
+		for (auto& angle : angles) {
+			util::quaternion q[3] = {
+				util::quaternion::from_axis_angle(1, 0, 0, angle[0]),
+				util::quaternion::from_axis_angle(0, 1, 0, angle[1]),
+				util::quaternion::from_axis_angle(0, 0, 1, angle[2]),
+			};
+
+			matrix4 expected;
+			matrix4_identity(&expected);
+			for (size_t axis : order.axes) {
+				matrix4_rotate_aa4f(&expected, &expected, axis == 0 ? 1.0f : 0.0f, axis == 1 ? 1.0f : 0.0f,
+					axis == 2 ? 1.0f : 0.0f, angle[axis]);
+			}
+
+			matrix4 actual;
+			util::matrix_from_quaternion(&actual,
+				util::combine(util::combine(q[order.axes[0]], q[order.axes[1]]), q[order.axes[2]]));
+			check_matrix(actual, expected);
+		}
+	}
+}
+
+// Every count up to a few blocks of four, so both the SSE path and the
+// remainder run, in place and out of place.
+static void test_transform_points() {
+	matrix4 m;
+	matrix4_identity(&m);
+	matrix4_rotate_aa4f(&m, &m, 0, 1, 0, 0.7f);
+	matrix4_rotate_aa4f(&m, &m, 1, 0, 0, -1.3f);
+	matrix4_translate3f(&m, &m, 10.0f, -4.0f, 2.5f);
+
+	for (size_t count = 0; count <= 13; count++) {
+		std::vector<vec3> in(count), out(count), expected(count);
+		for (size_t idx = 0; idx < count; idx++) {
+			float_t v = float_t(idx);
+			vec3_set(&in[idx], v - 3.0f, v * 0.5f, 1.0f - v * v * 0.1f);
+			vec3_transform(&expected[idx], &in[idx], &m);
+		}
+
+		util::transform_points(out.data(), in.data(), count, &m);
+		util::transform_points(in.data(), in.data(), count, &m);
+		for (size_t idx = 0; idx < count; idx++) {
+			TEST_CHECK_NEAR(out[idx].x, expected[idx].x, 0.0001);
+			TEST_CHECK_NEAR(out[idx].y, expected[idx].y, 0.0001);
+			TEST_CHECK_NEAR(out[idx].z, expected[idx].z, 0.0001);
+			TEST_CHECK(out[idx].w == 0.0f);
+			TEST_CHECK_NEAR(in[idx].x, expected[idx].x, 0.0001);
+			TEST_CHECK_NEAR(in[idx].y, expected[idx].y, 0.0001);
+			TEST_CHECK_NEAR(in[idx].z, expected[idx].z, 0.0001);
+		}
+	}
+}
+
+int main(int, char**) {
+	test_rotation_orders();
+	test_transform_points();
+	return 0;
+}
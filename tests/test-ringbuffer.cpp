@@ -0,0 +1,86 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-ringbuffer.h"
+#include <thread>
+
+static void test_capacity() {
+	util::spsc_ring<int> ring(5, 7);
+	TEST_CHECK(ring.capacity() == 8);
+	TEST_CHECK(ring.empty());
+	TEST_CHECK(ring.front() == nullptr);
+
+	// Elements start as copies of the prototype.
+	for (int idx = 0; idx < 8; idx++) {
+		int* slot = ring.acquire();
+		TEST_CHECK(slot != nullptr);
+		TEST_CHECK(*slot == 7);
+		*slot = idx;
+		ring.commit();
+	}
+	TEST_CHECK(ring.acquire() == nullptr);
+
+	for (int idx = 0; idx < 8; idx++) {
+		int* slot = ring.front();
+		TEST_CHECK(slot != nullptr);
+		TEST_CHECK(*slot == idx);
+		ring.pop();
+	}
+	TEST_CHECK(ring.empty());
+}
+
+// One producer and one consumer hammering a small ring. Every value must
+// arrive exactly once and in order.
+static void test_stress() {
+	const uint64_t count = 2000000;
+	util::spsc_ring<uint64_t> ring(16);
+
+	std::thread producer([&ring, count] {
+		for (uint64_t value = 0; value < count;) {
+			uint64_t* slot = ring.acquire();
+			if (!slot) {
+				std::this_thread::yield();
+				continue;
+			}
+			*slot = value++;
+			ring.commit();
+		}
+	});
+
+	uint64_t expected = 0;
+	while (expected < count) {
+		uint64_t* slot = ring.front();
+		if (!slot) {
+			std::this_thread::yield();
+			continue;
+		}
+		TEST_CHECK(*slot == expected);
+		expected++;
+		ring.pop();
+	}
+	producer.join();
+	TEST_CHECK(ring.empty());
+}
+
+int main(int, char**) {
+	test_capacity();
+	test_stress();
+	return 0;
+}
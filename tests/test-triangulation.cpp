@@ -0,0 +1,143 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "test.h"
+#include "util-triangulation.h"
+#include <math.h>
+
+static float_t signed_area(const vec2& a, const vec2& b, const vec2& c) {
+	return ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) * 0.5f;
+}
+
+static float_t outline_area(const std::vector<vec2>& points) {
+	float_t area = 0;
+	for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+		area += points[j].x * points[i].y - points[i].x * points[j].y;
+	}
+	return area * 0.5f;
+}
+
+// Triangles must wind like the outline and cover exactly its area.
+static void check_triangulation(const std::vector<vec2>& points, size_t triangles) {
+	std::vector<uint32_t> indices;
+	TEST_CHECK(util::triangulate(points.data(), points.size(), indices));
+	TEST_CHECK(indices.size() == triangles * 3);
+
+	float_t expected = outline_area(points);
+	float_t total = 0;
+	for (size_t idx = 0; idx < indices.size(); idx += 3) {
+		TEST_CHECK(indices[idx] < points.size());
+		TEST_CHECK(indices[idx + 1] < points.size());
+		TEST_CHECK(indices[idx + 2] < points.size());
+		float_t area = signed_area(points[indices[idx]], points[indices[idx + 1]], points[indices[idx + 2]]);
+		TEST_CHECK((area * expected) > 0);
+		total += area;
+	}
+	TEST_CHECK_NEAR(total, expected, 0.0001);
+}
+
+static std::vector<vec2> make_outline(std::initializer_list<std::pair<float_t, float_t>> coords) {
+	std::vector<vec2> points;
+	for (auto& coord : coords) {
+		vec2 point;
+		vec2_set(&point, coord.first, coord.second);
+		points.push_back(point);
+	}
+	return points;
+}
+
+static std::vector<vec2> reversed(std::vector<vec2> points) {
+	return std::vector<vec2>(points.rbegin(), points.rend());
+}
+
+static void test_convex() {
+	std::vector<vec2> square = make_outline({{0, 0}, {1, 0}, {1, 1}, {0, 1}});
+	check_triangulation(square, 2);
+	check_triangulation(reversed(square), 2);
+
+	std::vector<vec2> circle;
+	for (size_t idx = 0; idx < 32; idx++) {
+		vec2 point;
+		float_t angle = float_t(idx) / 32.0f * 6.2831853f;
+		vec2_set(&point, cosf(angle), sinf(angle));
+		circle.push_back(point);
+	}
+	check_triangulation(circle, 30);
+	check_triangulation(reversed(circle), 30);
+}
+
+static void test_concave() {
+	std::vector<vec2> ell = make_outline({{0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 2}});
+	check_triangulation(ell, 4);
+	check_triangulation(reversed(ell), 4);
+
+	std::vector<vec2> star;
+	for (size_t idx = 0; idx < 10; idx++) {
+		vec2 point;
+		float_t angle = float_t(idx) / 10.0f * 6.2831853f;
+		float_t radius = (idx % 2) ? 0.4f : 1.0f;
+		vec2_set(&point, cosf(angle) * radius, sinf(angle) * radius);
+		star.push_back(point);
+	}
+	check_triangulation(star, 8);
+	check_triangulation(reversed(star), 8);
+}
+
+static void test_collinear_duplicate() {
+	// Midpoints on the edges are dropped, so it is still two triangles.
+	std::vector<vec2> collinear = make_outline({{0, 0}, {0.5f, 0}, {1, 0}, {1, 0.5f}, {1, 1}, {0, 1}});
+	check_triangulation(collinear, 2);
+	check_triangulation(reversed(collinear), 2);
+
+	// Repeated points, also across the wrap around.
+	std::vector<vec2> duplicate = make_outline({{0, 0}, {0, 0}, {1, 0}, {1, 1}, {1, 1}, {0, 1}, {0, 0}});
+	check_triangulation(duplicate, 2);
+	check_triangulation(reversed(duplicate), 2);
+}
+
+static void test_invalid() {
+	std::vector<uint32_t> indices;
+
+	// Edges 0-1 and 2-3 cross.
+	std::vector<vec2> bowtie = make_outline({{0, 0}, {1, 1}, {1, 0}, {0, 1}});
+	TEST_CHECK(!util::triangulate(bowtie.data(), bowtie.size(), indices));
+	TEST_CHECK(indices.empty());
+	TEST_CHECK(!util::triangulate(reversed(bowtie).data(), bowtie.size(), indices));
+
+	// Crossing, but with more area on one side than the other.
+	std::vector<vec2> crossed = make_outline({{0, 0}, {4, 0}, {4, 4}, {2, 4}, {2, -1}, {0, -1}});
+	TEST_CHECK(!util::triangulate(crossed.data(), crossed.size(), indices));
+
+	std::vector<vec2> line = make_outline({{0, 0}, {1, 1}, {2, 2}});
+	TEST_CHECK(!util::triangulate(line.data(), line.size(), indices));
+
+	std::vector<vec2> point = make_outline({{1, 1}, {1, 1}, {1, 1}, {1, 1}});
+	TEST_CHECK(!util::triangulate(point.data(), point.size(), indices));
+
+	TEST_CHECK(!util::triangulate(bowtie.data(), 2, indices));
+	TEST_CHECK(!util::triangulate(nullptr, 4, indices));
+}
+
+int main(int, char**) {
+	test_convex();
+	test_concave();
+	test_collinear_duplicate();
+	test_invalid();
+	return 0;
+}
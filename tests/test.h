@@ -0,0 +1,42 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2018 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+// Minimal checks for the standalone test executables. A failed check prints
+// where it failed and ends the test with a non-zero exit code.
+#define TEST_CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			fprintf(stderr, "%s:%d: Check '%s' failed.\n", __FILE__, __LINE__, #expr); \
+			exit(1); \
+		} \
+	} while (false)
+
+#define TEST_CHECK_NEAR(a, b, tolerance) \
+	do { \
+		double _a = double(a), _b = double(b); \
+		if (!((_a - _b) <= (tolerance) && (_b - _a) <= (tolerance))) { \
+			fprintf(stderr, "%s:%d: Check '%s' (%g) near '%s' (%g) failed.\n", __FILE__, __LINE__, \
+				#a, _a, #b, _b); \
+			exit(1); \
+		} \
+	} while (false)